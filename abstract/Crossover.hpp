@@ -18,8 +18,12 @@ public:
     // No constructor as class doesn't need initialisation
     virtual ~Crossover() = 0; // Declare as pure virtual to prevent instantiation
 
+    // Define types to help readability
+    using Indices = typename POPULATIONTYPE::Indices;
+
     // Define pure virtual methods that derived classes must implement
-    virtual bool crossover(POPULATIONTYPE &parents, POPULATIONTYPE &children) = 0;
+    // Parents are given as indices into the population, as returned by selection
+    virtual bool crossover(POPULATIONTYPE &population, const Indices &parents, POPULATIONTYPE &children) = 0;
 };
 
 // Declare inline destructor to prevent linkage errors
@@ -3,6 +3,7 @@
 
 // Include system libraries
 #include <memory>
+#include <future>
 
 // Include abstract classes
 #include "Arguments.hpp"
@@ -10,6 +11,9 @@
 #include "RNG.hpp"
 #include "Population.hpp"
 
+// Include member classes
+#include "../util/WorkerThread.hpp"
+
 // Evaluator abstract class
 template <class POPULATIONTYPE>
 class Evaluator : public Arguments, public Settings, public RNG
@@ -20,10 +24,38 @@ public:
 
     // Define pure virtual methods that derived classes must implement
     virtual bool evaluate(POPULATIONTYPE &population) = 0;
+
+    // Evaluate the population on another thread, completing the future when every individual is scored
+    // The population must outlive the future, and the evaluator must not be used or destroyed until it completes
+    virtual std::future<bool> evaluateAsync(POPULATIONTYPE &population);
+
+    // Set the score beyond which individuals won't survive replacement, so scoring them can be stopped early
+    // Individuals stopped early are marked as rejected, and given a score that is beyond the cutoff
+    // Evaluators that always score individuals in full ignore the cutoff
+    virtual void setCutoff(const float){};
+    virtual void clearCutoff(){};
+
+private:
+    // Thread that evaluateAsync runs on, started the first time it is needed
+    std::unique_ptr<WorkerThread> asyncThread;
 };
 
 // Declare inline destructor to prevent linkage errors
 template <class POPULATIONTYPE>
 inline Evaluator<POPULATIONTYPE>::~Evaluator(){};
 
+// Evaluators that can't overlap with the caller any better are run on a thread of their own,
+// which is kept for the evaluator's lifetime rather than started for every population
+template <class POPULATIONTYPE>
+std::future<bool> Evaluator<POPULATIONTYPE>::evaluateAsync(POPULATIONTYPE &population)
+{
+    if (!asyncThread)
+    {
+        asyncThread.reset(new WorkerThread());
+    }
+
+    return asyncThread->run([this, &population]
+                            { return evaluate(population); });
+}
+
 #endif
\ No newline at end of file
@@ -1,31 +1,61 @@
 #ifndef _POPULATION_HPP_
 #define _POPULATION_HPP_
 
+// Include system libraries
+#include <vector>
+#include <memory>
+#include <memory_resource>
+
 // Include abstract classes
 #include "Genome.hpp"
 
+// Include member classes
+#include "../util/GenomePool.hpp"
+
 // Population abstract class
 template <class GENOMETYPE>
 class Population
 {
 public:
-    // No constructor as class doesn't need initialisation
+    // Define types to simplify expressions
+    using GenomeType = GENOMETYPE;
+    using GenomePointer = std::shared_ptr<GenomeType>;
+    using Individuals = std::pmr::vector<GenomePointer>;
+    using Indices = std::pmr::vector<unsigned int>; // Positions of individuals in a population
+    using Pool = GenomePool<GenomeType>;
+
+    // The individuals are stored in the given memory resource
+    // and new genomes are taken from the pool when one is given
+    Population(std::pmr::memory_resource *resource = std::pmr::get_default_resource(), Pool *pool = nullptr)
+        : individuals(resource),
+          pool(pool){};
     virtual ~Population() = 0; // Declare as pure virtual to prevent instantiation
 
     // Check that the templated parameter is derived from the Genome class
     static_assert(std::is_base_of<Genome, GENOMETYPE>());
 
-    // Define types to simplify expressions
-    using GenomeType = GENOMETYPE;
-    using GenomePointer = std::shared_ptr<GenomeType>;
-    using Individuals = std::vector<GenomePointer>;
+    // Create a genome for this population
+    GenomePointer createGenome()
+    {
+        return pool ? pool->acquire() : std::make_shared<GenomeType>();
+    }
+
+    // Get the memory resource used by this population, to allocate temporaries alongside it
+    std::pmr::memory_resource *getResource() const
+    {
+        return individuals.get_allocator().resource();
+    }
 
     // Use shared pointers to manage memory
     Individuals individuals;
+
+protected:
+    // Pool used to recycle genomes, may be null
+    Pool *pool;
 };
 
 // Declare inline destructor to prevent linkage errors
 template <class GENOMETYPE>
 inline Population<GENOMETYPE>::~Population(){};
 
-#endif
\ No newline at end of file
+#endif
@@ -4,25 +4,71 @@
 // Include system libraries
 #include <random>
 
+// Include utility classes
+#include "../util/RandomEngines.hpp"
+#include "../util/BulkRandom.hpp"
+#include "../util/CounterRNG.hpp"
+
 // Random Number Generator abstract class
 class RNG
 {
 public:
     RNG(){ // Default Constructor
         rng.seed(0);
+        bulkRng.seed(bulkSeed(0));
+        streamSeed = 0;
+        generation = 0;
     }
 
     RNG(RNG &copy){
         this->rng = copy.rng;
+        this->bulkRng = copy.bulkRng;
+        this->streamSeed = copy.streamSeed;
+        this->generation = copy.generation;
     }
 
     virtual ~RNG() = 0;  // Declare as pure virtual to prevent instantiation
 
     virtual void setRNGSeed(unsigned int seed){
         rng.seed(seed);
+        bulkRng.seed(bulkSeed(seed));
+        streamSeed = seed;
+    };
+
+    // Set the generation that the individual streams are keyed by
+    virtual void setGeneration(std::uint64_t generation){
+        this->generation = generation;
+    };
+
+    // Get the random stream of an individual in the current generation
+    // Each operator is seeded separately, so operators never share streams.
+    // The stream number lets an operator draw more than one stream per individual
+    // The streams only change with the generation, which the algorithm sets before every step
+    CounterRNG getIndividualRNG(std::uint64_t index, std::uint64_t stream = 0) const {
+        return CounterRNG(streamSeed, generation, index, stream);
     };
 
-    std::minstd_rand rng;
+    // Engine used by the operators, chosen when building
+    // std::minstd_rand is kept as the default so existing seeds give the same runs
+#if defined(GRACE_RNG_XOSHIRO256PP)
+    using Engine = Xoshiro256PlusPlus;
+#elif defined(GRACE_RNG_PCG32)
+    using Engine = PCG32;
+#else
+    using Engine = std::minstd_rand;
+#endif
+    Engine rng;
+
+    // Generator for filling whole buffers at once
+    BulkRandom bulkRng;
+
+protected:
+    unsigned int streamSeed; // Seed the individual streams are keyed by
+    std::uint64_t generation; // Generation the individual streams are keyed by
+
+private:
+    // Keep the bulk generator's lanes apart from the engine when both are seeded alike
+    static std::uint64_t bulkSeed(unsigned int seed) { return seed ^ 0xD1B54A32D192ED03ULL; }
 };
 
 inline RNG::~RNG(){};
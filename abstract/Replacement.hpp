@@ -20,12 +20,23 @@ public:
 
     // Define pure virtual methods that derived classes must implement
     virtual bool replace(POPULATIONTYPE &population, POPULATIONTYPE &children) = 0;
+
+    // Get the score a child must not be worse than to survive being put into the population,
+    // returning false if every child could survive
+    virtual bool getCutoff(POPULATIONTYPE &population, float &cutoff);
 };
 
 // Declare inline destructor to prevent linkage errors
 template <class POPULATIONTYPE>
 inline Replacement<POPULATIONTYPE>::~Replacement(){};
 
+// Replacement methods that keep children regardless of their score have no cutoff
+template <class POPULATIONTYPE>
+bool Replacement<POPULATIONTYPE>::getCutoff(POPULATIONTYPE &, float &)
+{
+    return false;
+}
+
 #endif
 
 
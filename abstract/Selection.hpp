@@ -18,8 +18,12 @@ public:
     // No constructor as class doesn't need initialisation
     virtual ~Selection() = 0; // Declare as pure virtual to prevent instantiation
 
+    // Define types to help readability
+    using Indices = typename POPULATIONTYPE::Indices;
+
     // Define pure virtual methods that derived classes must implement
-    virtual bool select(POPULATIONTYPE &population, POPULATIONTYPE &parents) = 0;
+    // Every entry of parents must be set to the index of a selected individual in the population
+    virtual bool select(POPULATIONTYPE &population, Indices &parents) = 0;
 };
 
 // Declare inline destructor to prevent linkage errors
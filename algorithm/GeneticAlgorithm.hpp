@@ -4,6 +4,8 @@
 // Include system libraries
 #include <type_traits>
 #include <climits>
+#include <memory>
+#include <future>
 
 // Include abstract classes
 #include "../abstract/EvolutionaryAlgorithm.hpp"
@@ -18,6 +20,10 @@
 #include "../abstract/Termination.hpp"
 #include "../abstract/Statistics.hpp"
 
+// Include member classes
+#include "../util/GenerationArena.hpp"
+#include "../util/GenomePool.hpp"
+
 // This template class implements a basic Genetic Algorithm with the following structure
 
 // Initial Generation:
@@ -26,14 +32,26 @@
 //     3. Evaluate the population
 
 // Subsequent Generations:
-//     1. Select parents from the population
-//     2. Create the children population using crossover
+//     1. Select the indices of parents from the population
+//     2. Create the children population from the parents using crossover
 //     3. Mutate the children population
 //     4. Map the children population
 //     5. Evaluate the children population
+//        Children whose effective codons weren't changed have their parent's phenotype and score, and are skipped
+//        Evaluators may stop scoring children that replacement's cutoff says won't survive
 //     6. Create a new population from the current and children population
 //     7. Terminate if conditions are met, otherwise repeat
 
+// In steady state mode, steps 1-6 breed only a few children at a time, which replacement puts
+// into the existing population. A generation is as many of these steps as it takes to breed
+// as many children as there are individuals.
+
+// Pipelined mode breeds in steady state steps too, but breeds and maps each step's children while the
+// previous step's children are evaluated asynchronously. A step's parents are selected before the previous
+// step's children are put into the population, so the results only depend on the seed and the number of
+// children per step, never on how long the evaluations take. The evaluator runs on another thread, so the
+// other operators must not share state with it.
+
 template <class POPULATION,
           class INITIALISER,
           class MAPPER,
@@ -59,6 +77,9 @@ public:
     // Genetic Algorithm methods
     void initialise();
     void step();
+    void generationalStep();
+    void steadyStateStep();
+    void pipelinedStep();
     void evolve();
 
 public: // TODO: Should these be private and define access classes?
@@ -74,6 +95,13 @@ public: // TODO: Should these be private and define access classes?
     // static_assert(std::is_base_of<Termination, TERMINATION>());
     // static_assert(std::is_base_of<Statistics, STATISTICS>());
 
+    // Genomes are recycled between generations by the pool, and each generation's
+    // temporary populations are allocated in the arena, which is reset after every step
+    // In pipelined mode the steps take turns with the second arena, as two steps are alive at once
+    GenomePool<typename POPULATION::GenomeType> genomePool;
+    GenerationArena generationArena;
+    GenerationArena pipelineArena;
+
     // Single population of individuals
     POPULATION population;
 
@@ -89,7 +117,36 @@ public: // TODO: Should these be private and define access classes?
     STATISTICS statistics;
 
 private:
+    // Children of a pipelined step, and the ones among them being evaluated
+    struct Batch
+    {
+        Batch(GenerationArena *arena, GenomePool<typename POPULATION::GenomeType> *pool)
+            : arena(arena),
+              children(arena, pool),
+              changedChildren(arena, pool){};
+
+        GenerationArena *arena; // Arena the step's populations are allocated in
+        POPULATION children;
+        POPULATION changedChildren;
+        std::future<bool> evaluation;
+    };
+
+    // Map and evaluate the children that need it
+    void evaluateChildren(POPULATION &children);
+    void getChangedChildren(POPULATION &children, POPULATION &changedChildren);
+    void setEvaluatorCutoff();
+
+    // Pipelined mode methods
+    std::unique_ptr<Batch> breedBatch(GenerationArena &arena);
+    void finishBatch(std::unique_ptr<Batch> &batch);
+
+    // Move the operators' individual random streams on to the next step
+    void advanceGeneration();
+
     int rngSeed;
+    bool isSteadyState;
+    bool isPipelined;
+    unsigned int childrenPerStep; // Only used in steady state mode
 };
 
 // Constructor
@@ -104,7 +161,11 @@ template <class POPULATION,
           class TERMINATION,
           class STATISTICS>
 GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::GeneticAlgorithm(int argc, char **argv, std::string settingsFile)
-    : rngSeed(0)
+    : population(std::pmr::get_default_resource(), &genomePool),
+      rngSeed(0),
+      isSteadyState(false),
+      isPipelined(false),
+      childrenPerStep(2)
 {
     // Initialise the command-line arguments
     cxxopts::Options arguments("GEGCC", "Grace - Written by Jack McEllin");
@@ -253,6 +314,45 @@ void GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CRO
         termination.setRNGSeed(rng());
     }
 
+    // Get the algorithm's mode
+    if (settings.HasValue("GeneticAlgorithm", "Mode"))
+    {
+        std::string mode = settings.Get("GeneticAlgorithm", "Mode", "UNKNOWN");
+
+        if (mode == "generational")
+        {
+            this->isSteadyState = false;
+            this->isPipelined = false;
+        }
+        else if (mode == "steadyState")
+        {
+            this->isSteadyState = true;
+            this->isPipelined = false;
+        }
+        else if (mode == "pipelined")
+        {
+            this->isSteadyState = true;
+            this->isPipelined = true;
+        }
+        else
+        {
+            std::cout << "Error: Invalid GeneticAlgorithm mode. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Get the number of children bred in each steady state or pipelined step
+    if (settings.HasValue("GeneticAlgorithm", "ChildrenPerStep"))
+    {
+        long childrenPerStep = settings.GetInteger("GeneticAlgorithm", "ChildrenPerStep", 2);
+        if (childrenPerStep < 1 || childrenPerStep > INT_MAX)
+        {
+            std::cout << "Error: Children per step must be between 1 and INT_MAX. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->childrenPerStep = childrenPerStep;
+    }
+
     // Pass settings file to each operator class for parsing
     initialiser.parseSettings(settings);
     mapper.parseSettings(settings);
@@ -285,6 +385,10 @@ void GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CRO
 
     // Evaluate the initial population
     evaluator.evaluate(population);
+    for (const typename POPULATION::GenomePointer &individual : population.individuals)
+    {
+        individual->isEvaluated = true;
+    }
 };
 
 template <class POPULATION,
@@ -299,25 +403,303 @@ template <class POPULATION,
           class STATISTICS>
 void GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::step()
 {
-    // Select parents from the current population
-    POPULATION parents;
+    if (!isSteadyState)
+    {
+        generationalStep();
+        return;
+    }
+
+    if (isPipelined)
+    {
+        pipelinedStep();
+        return;
+    }
+
+    // Breed a generation's worth of children in steady state steps
+    for (std::size_t children = 0; children < population.individuals.size(); children += childrenPerStep)
+    {
+        steadyStateStep();
+    }
+};
+
+template <class POPULATION,
+          class INITIALISER,
+          class MAPPER,
+          class EVALUATOR,
+          class SELECTION,
+          class CROSSOVER,
+          class MUTATION,
+          class REPLACEMENT,
+          class TERMINATION,
+          class STATISTICS>
+void GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::generationalStep()
+{
+    advanceGeneration();
+
+    // The generation's populations must be destroyed before the arena is reset
+    {
+        // Select parents from the current population
+        // Parents are the indices of the selected individuals
+        typename POPULATION::Indices parents(population.individuals.size(), &generationArena);
+        selection.select(population, parents);
+
+        // Create the children from the parents
+        POPULATION children(&generationArena, &genomePool);
+        crossover.crossover(population, parents, children);
+
+        // Mutate the children to add genetic diversity
+        mutation.mutate(children);
+
+        // Map and evaluate the children
+        evaluateChildren(children);
+
+        // Replace the current population with the new population
+        replacement.replace(population, children);
+    }
+
+    // Release this generation's temporaries
+    generationArena.reset();
+};
+
+template <class POPULATION,
+          class INITIALISER,
+          class MAPPER,
+          class EVALUATOR,
+          class SELECTION,
+          class CROSSOVER,
+          class MUTATION,
+          class REPLACEMENT,
+          class TERMINATION,
+          class STATISTICS>
+void GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::steadyStateStep()
+{
+    advanceGeneration();
+
+    // The step's populations must be destroyed before the arena is reset
+    {
+        // Select only the parents of this step's children
+        typename POPULATION::Indices parents(childrenPerStep, &generationArena);
+        selection.select(population, parents);
+
+        // Breed, map and evaluate the children
+        POPULATION children(&generationArena, &genomePool);
+        crossover.crossover(population, parents, children);
+        mutation.mutate(children);
+        evaluateChildren(children);
+
+        // Put the children into the population
+        replacement.replace(population, children);
+    }
+
+    // Release this step's temporaries
+    generationArena.reset();
+};
+
+template <class POPULATION,
+          class INITIALISER,
+          class MAPPER,
+          class EVALUATOR,
+          class SELECTION,
+          class CROSSOVER,
+          class MUTATION,
+          class REPLACEMENT,
+          class TERMINATION,
+          class STATISTICS>
+void GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::pipelinedStep()
+{
+    // Child populations of the step being evaluated
+    std::unique_ptr<Batch> evaluating;
+    GenerationArena *arenas[2] = {&generationArena, &pipelineArena};
+
+    // Breed a generation's worth of children in pipelined steps
+    std::size_t step = 0;
+    for (std::size_t children = 0; children < population.individuals.size(); children += childrenPerStep, ++step)
+    {
+        // Breed and map the next step's children while the last step's are evaluated
+        std::unique_ptr<Batch> bred = breedBatch(*arenas[step % 2]);
+
+        // Put the last step's children into the population
+        if (evaluating)
+        {
+            finishBatch(evaluating);
+        }
+
+        // Start evaluating the new children with their step's streams
+        evaluator.setGeneration(generation);
+        setEvaluatorCutoff();
+        bred->evaluation = evaluator.evaluateAsync(bred->changedChildren);
+        evaluating = std::move(bred);
+    }
+
+    // Finish the generation's last step
+    if (evaluating)
+    {
+        finishBatch(evaluating);
+    }
+};
+
+template <class POPULATION,
+          class INITIALISER,
+          class MAPPER,
+          class EVALUATOR,
+          class SELECTION,
+          class CROSSOVER,
+          class MUTATION,
+          class REPLACEMENT,
+          class TERMINATION,
+          class STATISTICS>
+std::unique_ptr<typename GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::Batch> GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::breedBatch(GenerationArena &arena)
+{
+    // The evaluator's streams are moved on when the step's evaluation starts, as it is still busy
+    setGeneration(generation + 1);
+    initialiser.setGeneration(generation);
+    mapper.setGeneration(generation);
+    selection.setGeneration(generation);
+    crossover.setGeneration(generation);
+    mutation.setGeneration(generation);
+    replacement.setGeneration(generation);
+    termination.setGeneration(generation);
+
+    std::unique_ptr<Batch> batch(new Batch(&arena, &genomePool));
+
+    // Select only the parents of this step's children
+    typename POPULATION::Indices parents(childrenPerStep, &arena);
     selection.select(population, parents);
 
-    // Create the children from the parents
-    POPULATION children;
-    crossover.crossover(parents, children);
+    // Breed the children, and map the ones that need evaluating
+    crossover.crossover(population, parents, batch->children);
+    mutation.mutate(batch->children);
+    getChangedChildren(batch->children, batch->changedChildren);
+    mapper.map(batch->changedChildren);
+
+    return batch;
+};
+
+template <class POPULATION,
+          class INITIALISER,
+          class MAPPER,
+          class EVALUATOR,
+          class SELECTION,
+          class CROSSOVER,
+          class MUTATION,
+          class REPLACEMENT,
+          class TERMINATION,
+          class STATISTICS>
+void GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::finishBatch(std::unique_ptr<Batch> &batch)
+{
+    // Wait for the step's evaluation
+    batch->evaluation.get();
+    for (const typename POPULATION::GenomePointer &child : batch->changedChildren.individuals)
+    {
+        child->isEvaluated = true;
+    }
+
+    // Put the children into the population
+    replacement.replace(population, batch->children);
 
-    // Mutate the children to add genetic diversity
-    mutation.mutate(children);
+    // The step's populations must be destroyed before its arena is reset
+    GenerationArena *arena = batch->arena;
+    batch.reset();
+    arena->reset();
+};
 
-    // Map the children
-    mapper.map(children);
+template <class POPULATION,
+          class INITIALISER,
+          class MAPPER,
+          class EVALUATOR,
+          class SELECTION,
+          class CROSSOVER,
+          class MUTATION,
+          class REPLACEMENT,
+          class TERMINATION,
+          class STATISTICS>
+void GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::evaluateChildren(POPULATION &children)
+{
+    POPULATION changedChildren(&generationArena, &genomePool);
+    getChangedChildren(children, changedChildren);
 
-    // Evaluate the children
-    evaluator.evaluate(children);
+    // Map the changed children
+    mapper.map(changedChildren);
 
-    // Replace the current population with the new population
-    replacement.replace(population, children);
+    // Evaluate the changed children
+    setEvaluatorCutoff();
+    evaluator.evaluate(changedChildren);
+    for (const typename POPULATION::GenomePointer &child : changedChildren.individuals)
+    {
+        child->isEvaluated = true;
+    }
+};
+
+template <class POPULATION,
+          class INITIALISER,
+          class MAPPER,
+          class EVALUATOR,
+          class SELECTION,
+          class CROSSOVER,
+          class MUTATION,
+          class REPLACEMENT,
+          class TERMINATION,
+          class STATISTICS>
+void GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::getChangedChildren(POPULATION &children, POPULATION &changedChildren)
+{
+    // Only children that aren't already evaluated are collected; neutral children keep their parent's phenotype and score
+    changedChildren.individuals.reserve(children.individuals.size());
+    for (const typename POPULATION::GenomePointer &child : children.individuals)
+    {
+        if (!child->isEvaluated)
+        {
+            changedChildren.individuals.push_back(child);
+        }
+    }
+};
+
+template <class POPULATION,
+          class INITIALISER,
+          class MAPPER,
+          class EVALUATOR,
+          class SELECTION,
+          class CROSSOVER,
+          class MUTATION,
+          class REPLACEMENT,
+          class TERMINATION,
+          class STATISTICS>
+void GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::setEvaluatorCutoff()
+{
+    // Children worse than the cutoff won't survive replacement, so they needn't be scored in full
+    float cutoff;
+    if (replacement.getCutoff(population, cutoff))
+    {
+        evaluator.setCutoff(cutoff);
+    }
+    else
+    {
+        evaluator.clearCutoff();
+    }
+};
+
+template <class POPULATION,
+          class INITIALISER,
+          class MAPPER,
+          class EVALUATOR,
+          class SELECTION,
+          class CROSSOVER,
+          class MUTATION,
+          class REPLACEMENT,
+          class TERMINATION,
+          class STATISTICS>
+void GeneticAlgorithm<POPULATION, INITIALISER, MAPPER, EVALUATOR, SELECTION, CROSSOVER, MUTATION, REPLACEMENT, TERMINATION, STATISTICS>::advanceGeneration()
+{
+    // Every step has its own streams, so in steady state mode each step counts as a generation
+    setGeneration(generation + 1);
+
+    initialiser.setGeneration(generation);
+    mapper.setGeneration(generation);
+    evaluator.setGeneration(generation);
+    selection.setGeneration(generation);
+    crossover.setGeneration(generation);
+    mutation.setGeneration(generation);
+    replacement.setGeneration(generation);
+    termination.setGeneration(generation);
 };
 
 template <class POPULATION,
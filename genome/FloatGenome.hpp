@@ -4,6 +4,7 @@
 // Include system libraries
 #include <vector>
 #include <string>
+#include <cstdint>
 
 // Include abstract classes
 #include "../genome/GEGenome.hpp"
@@ -12,15 +13,45 @@
 class FloatGenome : public GEGenome
 {
 public:
-    FloatGenome() : score(0.0){}; // Default constructor
-    FloatGenome(FloatGenome &copy) : GEGenome(copy) { // Copy constructor
-        score = copy.score;
-    };
+    FloatGenome() : score(0.0), fidelity(0){}; // Default constructor
+    FloatGenome(const FloatGenome &copy) : GEGenome(copy), // Copy constructor
+                                           score(copy.score),
+                                           fidelity(copy.fidelity){};
+    FloatGenome(FloatGenome &&other) noexcept : GEGenome(std::move(other)), // Move constructor
+                                                score(other.score),
+                                                fidelity(other.fidelity){};
     ~FloatGenome(){}; // Destructor
 
+    // Copy assignment
+    FloatGenome &operator=(const FloatGenome &copy)
+    {
+        GEGenome::operator=(copy);
+        score = copy.score;
+        fidelity = copy.fidelity;
+        return *this;
+    }
+
+    // Move assignment
+    FloatGenome &operator=(FloatGenome &&other) noexcept
+    {
+        GEGenome::operator=(std::move(other));
+        score = other.score;
+        fidelity = other.fidelity;
+        return *this;
+    }
+
+    // Return the genome to its default state, keeping the capacity of its buffers
+    void reset() override
+    {
+        GEGenome::reset();
+        score = 0.0;
+        fidelity = 0;
+    }
+
 public:
-    // Member variable
+    // Member variables
     float score;
+    std::uint8_t fidelity; // Level of the data the score was found on, 0 is all of it and higher levels less of it
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -4,44 +4,106 @@
 // Include system libraries
 #include <vector>
 #include <string>
+#include <memory>
+#include <cstdint>
 
 // Include abstract classes
 #include "../abstract/Genome.hpp"
 
 // Include member classes
 #include "../grammar/CFGrammar.hpp"
+#include "../util/Genotype.hpp"
 
 // This class implements...
 class GEGenome : public Genome
 {
 public:
     GEGenome() : phenotype(""), // Default Constructor - Initialise member variables
+                 phenotypeHash(0),
                  effectiveSize(0),
                  isPhenotypeValid(false),
-                 isEvaluated(false){};
+                 isEvaluated(false),
+                 isRejected(false){};
 
-    GEGenome(GEGenome &copy) // Copy constructor
-    { 
+    // Copy constructor - The genotype, grammar and derivation tree are shared, not copied
+    GEGenome(const GEGenome &copy) : genotype(copy.genotype),
+                                     phenotype(copy.phenotype),
+                                     phenotypeHash(copy.phenotypeHash),
+                                     grammar(copy.grammar),
+                                     derivationTree(copy.derivationTree),
+                                     effectiveSize(copy.effectiveSize),
+                                     isPhenotypeValid(copy.isPhenotypeValid),
+                                     isEvaluated(copy.isEvaluated),
+                                     isRejected(copy.isRejected){};
+
+    // Move constructor
+    GEGenome(GEGenome &&other) noexcept : genotype(std::move(other.genotype)),
+                                          phenotype(std::move(other.phenotype)),
+                                          phenotypeHash(other.phenotypeHash),
+                                          grammar(std::move(other.grammar)),
+                                          derivationTree(std::move(other.derivationTree)),
+                                          effectiveSize(other.effectiveSize),
+                                          isPhenotypeValid(other.isPhenotypeValid),
+                                          isEvaluated(other.isEvaluated),
+                                          isRejected(other.isRejected){};
+
+    virtual ~GEGenome(){}; // Destructor
+
+    // Copy assignment
+    GEGenome &operator=(const GEGenome &copy)
+    {
         genotype = copy.genotype;
         phenotype = copy.phenotype;
+        phenotypeHash = copy.phenotypeHash;
         grammar = copy.grammar;
         derivationTree = copy.derivationTree;
         effectiveSize = copy.effectiveSize;
         isPhenotypeValid = copy.isPhenotypeValid;
         isEvaluated = copy.isEvaluated;
+        isRejected = copy.isRejected;
+        return *this;
     }
 
-    virtual ~GEGenome(){}; // Destructor
+    // Move assignment
+    GEGenome &operator=(GEGenome &&other) noexcept
+    {
+        genotype = std::move(other.genotype);
+        phenotype = std::move(other.phenotype);
+        phenotypeHash = other.phenotypeHash;
+        grammar = std::move(other.grammar);
+        derivationTree = std::move(other.derivationTree);
+        effectiveSize = other.effectiveSize;
+        isPhenotypeValid = other.isPhenotypeValid;
+        isEvaluated = other.isEvaluated;
+        isRejected = other.isRejected;
+        return *this;
+    }
+
+    // Return the genome to its default state, keeping the capacity of its buffers
+    virtual void reset()
+    {
+        genotype.clear();
+        phenotype.clear();
+        phenotypeHash = 0;
+        grammar.reset();
+        derivationTree.reset();
+        effectiveSize = 0;
+        isPhenotypeValid = false;
+        isEvaluated = false;
+        isRejected = false;
+    }
 
 public:
     // Member variables
-    std::vector<unsigned int> genotype;
+    Genotype genotype;                              // Copy-on-write codons
     std::string phenotype;
-    CFGrammar grammar;
-    DerivationTree derivationTree;
+    std::uint64_t phenotypeHash;                    // FNV-1a hash of the phenotype, built by the mapper
+    std::shared_ptr<CFGrammar> grammar;             // Shared between all individuals using the same grammar
+    std::shared_ptr<DerivationTree> derivationTree; // Rebuilt by the mapper, never modified in place once shared
     unsigned int effectiveSize;
     bool isPhenotypeValid; // Used to indicate if the genotype has been modified or the mapping has failed
     bool isEvaluated;      // Used to skip mapping & evaluation if the genotype hasn't changed
+    bool isRejected;       // Scoring was stopped at the cutoff, so the score is only a bound beyond it
 };
 
-#endif
\ No newline at end of file
+#endif
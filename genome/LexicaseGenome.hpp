@@ -0,0 +1,51 @@
+#ifndef _LEXICASEGENOME_HPP_
+#define _LEXICASEGENOME_HPP_
+
+// Include system libraries
+#include <vector>
+#include <string>
+
+// Include abstract classes
+#include "../genome/FloatGenome.hpp"
+
+// This class implements a genome that keeps its error on every fitness case
+// as well as the aggregate score, for use with lexicase selection
+class LexicaseGenome : public FloatGenome
+{
+public:
+    LexicaseGenome(){}; // Default constructor
+    LexicaseGenome(const LexicaseGenome &copy) : FloatGenome(copy), // Copy constructor
+                                                 errors(copy.errors){};
+    LexicaseGenome(LexicaseGenome &&other) noexcept : FloatGenome(std::move(other)), // Move constructor
+                                                      errors(std::move(other.errors)){};
+    ~LexicaseGenome(){}; // Destructor
+
+    // Copy assignment
+    LexicaseGenome &operator=(const LexicaseGenome &copy)
+    {
+        FloatGenome::operator=(copy);
+        errors = copy.errors;
+        return *this;
+    }
+
+    // Move assignment
+    LexicaseGenome &operator=(LexicaseGenome &&other) noexcept
+    {
+        FloatGenome::operator=(std::move(other));
+        errors = std::move(other.errors);
+        return *this;
+    }
+
+    // Return the genome to its default state, keeping the capacity of its buffers
+    void reset() override
+    {
+        FloatGenome::reset();
+        errors.clear();
+    }
+
+public:
+    // Member variable
+    std::vector<float> errors; // Error on each fitness case, lower is better
+};
+
+#endif
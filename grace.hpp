@@ -24,21 +24,48 @@
 // Genomes
 #include "./genome/GEGenome.hpp"
 #include "./genome/FloatGenome.hpp"
+#include "./genome/LexicaseGenome.hpp"
 
 // Populations
 #include "./population/FloatPopulation.hpp"
+#include "./population/LexicasePopulation.hpp"
 
 // Operator classes
 #include "./operators/crossover/GECrossover.hpp"
+#include "./operators/evaluator/CachedEvaluator.hpp"
+#include "./operators/evaluator/ParallelEvaluator.hpp"
+#include "./operators/evaluator/BytecodeEvaluator.hpp"
+#include "./operators/evaluator/BooleanEvaluator.hpp"
+#include "./operators/evaluator/SubprocessEvaluator.hpp"
+#include "./operators/evaluator/MultiFidelityEvaluator.hpp"
 #include "./operators/initialiser/GEInitialiser.hpp"
 #include "./operators/mapper/GEMapper.hpp"
 #include "./operators/mutation/GEMutation.hpp"
 #include "./operators/replacement/FloatReplacement.hpp"
 #include "./operators/selection/FloatSelection.hpp"
+#include "./operators/selection/LexicaseSelection.hpp"
 #include "./operators/statistics/FloatStatistics.hpp"
 #include "./operators/termination/GETermination.hpp"
 
 // Utility classes
 #include "util/DerivationTree.hpp"
+#include "util/Genotype.hpp"
+#include "util/GenomePool.hpp"
+#include "util/GenerationArena.hpp"
+#include "util/ThreadPool.hpp"
+#include "util/WorkerThread.hpp"
+#include "util/ParallelChunks.hpp"
+#include "util/IndexedHeap.hpp"
+#include "util/RandomEngines.hpp"
+#include "util/BulkRandom.hpp"
+#include "util/CounterRNG.hpp"
+#include "util/LRUCache.hpp"
+#include "util/PersistentCache.hpp"
+#include "util/IncrementalError.hpp"
+#include "util/Bytecode.hpp"
+#include "util/NativeModule.hpp"
+#include "util/BooleanCircuit.hpp"
+#include "util/WorkerProcess.hpp"
+#include "util/ColumnarDataset.hpp"
 
 #endif
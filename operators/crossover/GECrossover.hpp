@@ -1,9 +1,16 @@
 #ifndef _GECROSSOVER_HPP_
 #define _GECROSSOVER_HPP_
 
+// Include system libraries
+#include <memory>
+#include <algorithm>
+
 // Include abstract classes
 #include "../../abstract/Crossover.hpp"
 
+// Include utility classes
+#include "../../util/ParallelChunks.hpp"
+
 // This template class provides crossover methods that work
 // with all classes that inherit GEGenome
 template <class POPULATIONTYPE>
@@ -14,6 +21,7 @@ public:
     using GenomeType = typename POPULATIONTYPE::GenomeType;
     using GenomePointer = typename POPULATIONTYPE::GenomePointer;
     using Individuals = typename POPULATIONTYPE::Individuals;
+    using Indices = typename POPULATIONTYPE::Indices;
 
     GECrossover();           // Default constructor
     ~GECrossover() override; // Destructor
@@ -24,23 +32,25 @@ public:
     void parseSettings(INIReader &) override;
 
     // Implement pure virtual method from Crossover
-    bool crossover(POPULATIONTYPE &parents, POPULATIONTYPE &children) override;
+    bool crossover(POPULATIONTYPE &population, const Indices &parents, POPULATIONTYPE &children) override;
 
 protected:
     // Available crossover methods
-    bool fixedOnePoint(POPULATIONTYPE &parents, POPULATIONTYPE &children);
+    bool fixedOnePoint(POPULATIONTYPE &population, const Indices &parents, POPULATIONTYPE &children);
 
     // Variables
     float rate;
+    ParallelChunks parallelChunks; // Runs the work over large populations on worker threads
 
     // Work methods
-    bool fixedOnePointGenome(const GenomeType &mom, const GenomeType &dad, GenomeType &child1, GenomeType &child2);
+    bool fixedOnePointGenome(const GenomeType &mom, const GenomeType &dad, GenomeType &child1, GenomeType &child2, CounterRNG &rng);
+    void inheritParent(const GenomeType &parent, GenomeType &child, const std::size_t unchangedCodons);
 
 private:
     // Method pointer is private so that the prototype can be changed in the derived class
     // Note that this only hides the CrossoverMethod variable.
     // TODO: Template this so that the definition can change correctly.
-    typedef bool (GECrossover::*CrossoverMethod)(POPULATIONTYPE &parents, POPULATIONTYPE &children);
+    typedef bool (GECrossover::*CrossoverMethod)(POPULATIONTYPE &population, const Indices &parents, POPULATIONTYPE &children);
     CrossoverMethod method;
 };
 
@@ -48,7 +58,8 @@ private:
 template <class POPULATIONTYPE>
 GECrossover<POPULATIONTYPE>::GECrossover()
     : method(&GECrossover<POPULATIONTYPE>::fixedOnePoint),
-      rate(0.9){};
+      rate(0.9),
+      parallelChunks(256, 1024){};
 
 // Destructor
 template <class POPULATIONTYPE>
@@ -88,6 +99,9 @@ void GECrossover<POPULATIONTYPE>::parseSettings(INIReader &settings)
             exit(EXIT_FAILURE);
         }
     }
+
+    // Get the threads used for large populations
+    parallelChunks.parseSettings(settings, "GECrossover");
 }
 
 // Add command-line arguments
@@ -114,58 +128,55 @@ void GECrossover<POPULATIONTYPE>::parseArguments(cxxopts::ParseResult &results)
 
 // Implement pure virtual method from base class
 template <class POPULATIONTYPE>
-bool GECrossover<POPULATIONTYPE>::crossover(POPULATIONTYPE &parents, POPULATIONTYPE &children)
+bool GECrossover<POPULATIONTYPE>::crossover(POPULATIONTYPE &population, const Indices &parents, POPULATIONTYPE &children)
 {
-    return (this->*method)(parents, children);
+    return (this->*method)(population, parents, children);
 }
 
 // Fixed one point crossover
 template <class POPULATIONTYPE>
-bool GECrossover<POPULATIONTYPE>::fixedOnePoint(POPULATIONTYPE &parents, POPULATIONTYPE &children)
+bool GECrossover<POPULATIONTYPE>::fixedOnePoint(POPULATIONTYPE &population, const Indices &parents, POPULATIONTYPE &children)
 {
     // Check that we have parents
-    if (parents.individuals.size() < 2)
+    if (parents.size() < 2)
     {
         std::cout << "Error: Parent population size is less than two. Exiting..." << std::endl;
         exit(EXIT_FAILURE);
     }
 
-    // Take two parents at a time
-    typename Individuals::iterator currentIndividualIt = parents.individuals.begin();
-    while ((currentIndividualIt + 2) < parents.individuals.end())
+    // Preallocate the children so that each pair writes into its own slots
+    // Genomes come from the population's pool, which isn't thread safe, so they are created up front
+    children.individuals.resize(parents.size());
+    for (GenomePointer &child : children.individuals)
     {
-        const GenomeType &mom = **currentIndividualIt;
-        const GenomeType &dad = **(currentIndividualIt + 1);
-
-        GenomePointer child1 = std::make_shared<GenomeType>();
-        GenomePointer child2 = std::make_shared<GenomeType>();
-
-        // Perform the crossover
-        fixedOnePointGenome(mom, dad, *child1, *child2);
-
-        // Copy the grammar to the children
-        child1->grammar = mom.grammar;
-        child2->grammar = dad.grammar;
-
-        // Invalidate the children
-        child1->isPhenotypeValid = false;
-        child2->isPhenotypeValid = false;
-        child1->isEvaluated = false;
-        child2->isEvaluated = false;
-
-        // Add child1 and child2 to the children population
-        children.individuals.push_back(child1);
-        children.individuals.push_back(child2);
-
-        // Increment the iterator by 2
-        currentIndividualIt = currentIndividualIt + 2;
+        child = children.createGenome();
     }
 
+    // Take two parents at a time
+    parallelChunks.run(parents.size() / 2, [this, &population, &parents, &children](std::size_t begin, std::size_t end, std::size_t)
+                       {
+                           for (std::size_t pair = begin; pair < end; ++pair)
+                           {
+                               std::size_t index = 2 * pair;
+                               const GenomeType &mom = *population.individuals[parents[index]];
+                               const GenomeType &dad = *population.individuals[parents[index + 1]];
+
+                               // Perform the crossover with the pair's own random stream
+                               CounterRNG rng = this->getIndividualRNG(index);
+                               fixedOnePointGenome(mom, dad, *children.individuals[index], *children.individuals[index + 1], rng);
+                           }
+                       });
+
     // Check to see if there is an individual left
-    if (currentIndividualIt != parents.individuals.end())
+    std::size_t index = parents.size() - 1;
+    if (parents.size() % 2 == 1)
     {
-        // Add the last individual as fixed point would create a copy of the parent
-        children.individuals.push_back(*currentIndividualIt);
+        // Fixed point crossover would create a copy of the parent.
+        // The copy shares the parent's codons until it is mutated
+        const GenomeType &parent = *population.individuals[parents[index]];
+        GenomePointer &child = children.individuals[index];
+        child->genotype = parent.genotype;
+        inheritParent(parent, *child, child->genotype.size());
     }
 
     return true;
@@ -173,11 +184,11 @@ bool GECrossover<POPULATIONTYPE>::fixedOnePoint(POPULATIONTYPE &parents, POPULAT
 
 // This method creates two children from two parents for fixed one point crossover
 template <class POPULATIONTYPE>
-bool GECrossover<POPULATIONTYPE>::fixedOnePointGenome(const GenomeType &mom, const GenomeType &dad, GenomeType &child1, GenomeType &child2)
+bool GECrossover<POPULATIONTYPE>::fixedOnePointGenome(const GenomeType &mom, const GenomeType &dad, GenomeType &child1, GenomeType &child2, CounterRNG &rng)
 {
     // Select a random number between 0 & 1
     std::uniform_real_distribution<> probability(0.0, 1.0);
-    double result = probability(this->rng);
+    double result = probability(rng);
 
     // If the result is less than the crossover rate, perform crossover
     if (result < this->rate)
@@ -186,22 +197,55 @@ bool GECrossover<POPULATIONTYPE>::fixedOnePointGenome(const GenomeType &mom, con
         std::uniform_int_distribution<> distribution(0, mom.genotype.size() < dad.genotype.size() ? mom.genotype.size() : dad.genotype.size());
 
         // Choose a crossover point
-        unsigned int crossoverPoint = distribution(this->rng);
-
-        // Copy codons to the children
-        std::copy(mom.genotype.begin(), mom.genotype.begin() + crossoverPoint, std::back_inserter(child1.genotype));
-        std::copy(dad.genotype.begin() + crossoverPoint, dad.genotype.end(), std::back_inserter(child1.genotype));
-        std::copy(dad.genotype.begin(), dad.genotype.begin() + crossoverPoint, std::back_inserter(child2.genotype));
-        std::copy(mom.genotype.begin() + crossoverPoint, mom.genotype.end(), std::back_inserter(child2.genotype));
+        unsigned int crossoverPoint = distribution(rng);
+
+        // Write the codons into the children's preallocated buffers
+        Genotype::Codons &codons1 = child1.genotype.modify();
+        Genotype::Codons &codons2 = child2.genotype.modify();
+        codons1.resize(dad.genotype.size());
+        codons2.resize(mom.genotype.size());
+
+        std::copy(mom.genotype.begin(), mom.genotype.begin() + crossoverPoint, codons1.begin());
+        std::copy(dad.genotype.begin() + crossoverPoint, dad.genotype.end(), codons1.begin() + crossoverPoint);
+        std::copy(dad.genotype.begin(), dad.genotype.begin() + crossoverPoint, codons2.begin());
+        std::copy(mom.genotype.begin() + crossoverPoint, mom.genotype.end(), codons2.begin() + crossoverPoint);
+
+        // Each child starts with its parent's codons up to the crossover point
+        inheritParent(mom, child1, crossoverPoint);
+        inheritParent(dad, child2, crossoverPoint);
     }
     else
     {
-        // Copy parents to children directly
-        // TODO: The parents should be added to the children population directly to avoid copying
-        std::copy(mom.genotype.begin(), mom.genotype.end(), std::back_inserter(child1.genotype));
-        std::copy(dad.genotype.begin(), dad.genotype.end(), std::back_inserter(child2.genotype));
+        // Share the parents' codons with the children. They are only copied if mutated
+        child1.genotype = mom.genotype;
+        child2.genotype = dad.genotype;
+        inheritParent(mom, child1, child1.genotype.size());
+        inheritParent(dad, child2, child2.genotype.size());
     }
     return true;
 }
 
+// Set up a child that shares its first unchangedCodons codons with the parent
+// If the parent's mapping only read those codons, the child maps to the same phenotype and has the same score,
+// so it takes them from the parent rather than being mapped and evaluated again.
+// Otherwise the child is invalidated, and all of its codons count as effective until it is mapped
+template <class POPULATIONTYPE>
+void GECrossover<POPULATIONTYPE>::inheritParent(const GenomeType &parent, GenomeType &child, const std::size_t unchangedCodons)
+{
+    if (parent.isPhenotypeValid && parent.isEvaluated && parent.effectiveSize > 0 && parent.effectiveSize <= unchangedCodons)
+    {
+        // Copy everything but the codons, sharing the parent's derivation tree
+        Genotype genotype = std::move(child.genotype);
+        child = parent;
+        child.genotype = std::move(genotype);
+    }
+    else
+    {
+        child.grammar = parent.grammar;
+        child.isPhenotypeValid = false;
+        child.isEvaluated = false;
+        child.effectiveSize = child.genotype.size();
+    }
+}
+
 #endif
@@ -0,0 +1,211 @@
+#ifndef _BOOLEANEVALUATOR_HPP_
+#define _BOOLEANEVALUATOR_HPP_
+
+// Include system libraries
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Include abstract classes
+#include "../../abstract/Evaluator.hpp"
+
+// Include utility classes
+#include "../../util/BooleanCircuit.hpp"
+
+// This template class scores Boolean phenotypes against the full truth table of a circuit problem.
+// Each phenotype is compiled to a list of gates, which is worked out for 64 rows at a time per word.
+// The score is the number of output bits the circuit gets right over every row, so higher scores are better.
+// The problems and the names of their inputs are:
+// - EvenParity and OddParity of Size inputs x0, x1, ..., true when an even or odd number of inputs are true
+// - Multiplexer with Size address inputs a0, a1, ... choosing one of the data inputs d0, d1, ...
+// - Adder of two Size bit numbers a0, a1, ... and b0, b1, ..., with one output for each bit of the sum,
+//   lowest first, separated by ';'
+// Input a0 and x0 are the lowest bits of the row. Individuals that are invalid or don't compile get the invalid score.
+template <class POPULATIONTYPE>
+class BooleanEvaluator : public Evaluator<POPULATIONTYPE>
+{
+public:
+    // Define types to help readability
+    using GenomeType = typename POPULATIONTYPE::GenomeType;
+    using GenomePointer = typename POPULATIONTYPE::GenomePointer;
+
+    BooleanEvaluator();           // Default constructor
+    ~BooleanEvaluator() override; // Destructor
+
+    // Command-line & settings file methods
+    void addArguments(cxxopts::Options &) override;
+    void parseArguments(cxxopts::ParseResult &) override;
+    void parseSettings(INIReader &) override;
+
+    // Implement pure virtual method from Evaluator
+    bool evaluate(POPULATIONTYPE &population) override;
+
+    // Get the hits of one phenotype, returning false if it doesn't compile
+    bool getHits(const std::string &phenotype, std::uint64_t &hits);
+
+    // Get methods
+    std::uint64_t getMaxHits() const; // Score of a perfect circuit
+    const std::vector<std::string> &getInputNames() const;
+
+protected:
+    // Variables
+    float invalidScore; // Score given to individuals that can't be scored
+
+    std::vector<std::string> inputNames;
+    BooleanCompiler compiler;
+    TruthTable truthTable;
+    BooleanCircuit::Circuit circuit; // Kept between individuals to avoid reallocating it
+};
+
+// Default constructor
+template <class POPULATIONTYPE>
+BooleanEvaluator<POPULATIONTYPE>::BooleanEvaluator()
+    : invalidScore(0.0){};
+
+// Destructor
+template <class POPULATIONTYPE>
+BooleanEvaluator<POPULATIONTYPE>::~BooleanEvaluator(){};
+
+// Settings file parsing
+template <class POPULATIONTYPE>
+void BooleanEvaluator<POPULATIONTYPE>::parseSettings(INIReader &settings)
+{
+    // Get the score given to individuals that can't be scored
+    if (settings.HasValue("BooleanEvaluator", "InvalidScore"))
+    {
+        this->invalidScore = settings.GetReal("BooleanEvaluator", "InvalidScore", 0.0);
+    }
+
+    // Get the problem and its size
+    std::string problem = settings.Get("BooleanEvaluator", "Problem", "");
+    long size = settings.GetInteger("BooleanEvaluator", "Size", 0);
+    if (size < 1)
+    {
+        std::cout << "Error: BooleanEvaluator size must be at least 1. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // The truth table is kept in memory, so its inputs are limited
+    const long maxInputs = 30;
+    inputNames.clear();
+
+    if (problem == "EvenParity" || problem == "OddParity")
+    {
+        if (size > maxInputs)
+        {
+            std::cout << "Error: BooleanEvaluator problem has too many inputs. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        for (long input = 0; input < size; ++input)
+        {
+            inputNames.push_back("x" + std::to_string(input));
+        }
+
+        std::uint64_t odd = problem == "OddParity";
+        truthTable.setTargets(size, 1, [odd](std::uint64_t row)
+                              { return (__builtin_popcountll(row) & 1) ^ odd ^ 1; });
+    }
+    else if (problem == "Multiplexer")
+    {
+        // Five address inputs would need 37 inputs
+        if (size > 4)
+        {
+            std::cout << "Error: BooleanEvaluator problem has too many inputs. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        for (long input = 0; input < size; ++input)
+        {
+            inputNames.push_back("a" + std::to_string(input));
+        }
+        for (long input = 0; input < (1L << size); ++input)
+        {
+            inputNames.push_back("d" + std::to_string(input));
+        }
+
+        truthTable.setTargets(size + (1L << size), 1, [size](std::uint64_t row)
+                              { return (row >> (size + (row & ((1ULL << size) - 1)))) & 1; });
+    }
+    else if (problem == "Adder")
+    {
+        if (2 * size > maxInputs)
+        {
+            std::cout << "Error: BooleanEvaluator problem has too many inputs. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        for (long input = 0; input < size; ++input)
+        {
+            inputNames.push_back("a" + std::to_string(input));
+        }
+        for (long input = 0; input < size; ++input)
+        {
+            inputNames.push_back("b" + std::to_string(input));
+        }
+
+        truthTable.setTargets(2 * size, size + 1, [size](std::uint64_t row)
+                              { return (row & ((1ULL << size) - 1)) + (row >> size); });
+    }
+    else
+    {
+        std::cout << "Error: Invalid BooleanEvaluator problem. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    compiler.setInputs(inputNames);
+}
+
+// Add command-line arguments
+template <class POPULATIONTYPE>
+void BooleanEvaluator<POPULATIONTYPE>::addArguments(cxxopts::Options &options){};
+
+// Parse command-line arguments
+template <class POPULATIONTYPE>
+void BooleanEvaluator<POPULATIONTYPE>::parseArguments(cxxopts::ParseResult &results){};
+
+// Implement pure virtual method from base class
+template <class POPULATIONTYPE>
+bool BooleanEvaluator<POPULATIONTYPE>::evaluate(POPULATIONTYPE &population)
+{
+    for (const GenomePointer &individual : population.individuals)
+    {
+        if (individual->isEvaluated)
+        {
+            continue;
+        }
+
+        std::uint64_t hits;
+        individual->score = individual->isPhenotypeValid && getHits(individual->phenotype, hits) ? hits : invalidScore;
+        individual->isEvaluated = true;
+    }
+    return true;
+}
+
+template <class POPULATIONTYPE>
+bool BooleanEvaluator<POPULATIONTYPE>::getHits(const std::string &phenotype, std::uint64_t &hits)
+{
+    // A phenotype with the wrong number of outputs doesn't compile for this problem
+    if (!compiler.compile(phenotype, circuit) || circuit.outputs.size() != truthTable.getOutputCount())
+    {
+        return false;
+    }
+
+    hits = truthTable.countHits(circuit);
+    return true;
+}
+
+// Get methods
+template <class POPULATIONTYPE>
+std::uint64_t BooleanEvaluator<POPULATIONTYPE>::getMaxHits() const
+{
+    return truthTable.getMaxHits();
+}
+
+template <class POPULATIONTYPE>
+const std::vector<std::string> &BooleanEvaluator<POPULATIONTYPE>::getInputNames() const
+{
+    return inputNames;
+}
+
+#endif
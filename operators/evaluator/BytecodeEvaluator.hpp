@@ -0,0 +1,663 @@
+#ifndef _BYTECODEEVALUATOR_HPP_
+#define _BYTECODEEVALUATOR_HPP_
+
+// Include system libraries
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <cstdint>
+#include <sstream>
+#include <limits>
+#include <cmath>
+#include <cstdlib>
+
+// Include abstract classes
+#include "../../abstract/Evaluator.hpp"
+
+// Include utility classes
+#include "../../util/Bytecode.hpp"
+#include "../../util/ColumnarDataset.hpp"
+#include "../../util/IncrementalError.hpp"
+#include "../../util/LRUCache.hpp"
+#include "../../util/NativeModule.hpp"
+
+// This template class scores arithmetic expression phenotypes against a dataset, for symbolic regression.
+// Each phenotype is compiled to bytecode once, then run over every row of the dataset a block at a time,
+// rather than walking the expression once per row. The dataset is a CSV file with a header of column names;
+// expressions use the column names as variables, and one column holds the target value. The CSV file is
+// converted once into a columnar file that is memory-mapped, and shared by every evaluator in the process
+// using the same file. The last rows can be held back for validation, and aren't used for scoring.
+// The score is the error between the expression and the target, so lower scores are better.
+// Individuals that are invalid, don't compile, or give a non-finite error get the invalid score.
+// In native mode the phenotypes of a generation are written as C functions in one source file, which is
+// compiled by the system compiler and loaded, so the cost of the compiler is shared by the whole batch.
+// Compiled functions are cached by phenotype hash. If the compiler can't be used, phenotypes are interpreted.
+// Given a cutoff, scoring stops once the error is known to be worse than it, and the individual is rejected.
+// Individuals can also be scored on a subsample of the rows, which is copied out so its rows are contiguous.
+template <class POPULATIONTYPE>
+class BytecodeEvaluator : public Evaluator<POPULATIONTYPE>
+{
+public:
+    // Define types to help readability
+    using GenomeType = typename POPULATIONTYPE::GenomeType;
+    using GenomePointer = typename POPULATIONTYPE::GenomePointer;
+
+    BytecodeEvaluator();           // Default constructor
+    ~BytecodeEvaluator() override; // Destructor
+
+    // Command-line & settings file methods
+    void addArguments(cxxopts::Options &) override;
+    void parseArguments(cxxopts::ParseResult &) override;
+    void parseSettings(INIReader &) override;
+
+    // Implement pure virtual method from Evaluator
+    bool evaluate(POPULATIONTYPE &population) override;
+
+    // Stop scoring individuals once their error is past the cutoff
+    void setCutoff(const float cutoff) override;
+    void clearCutoff() override;
+
+    // Score individuals on only the given rows until the subsample is cleared
+    void setSubsample(const std::vector<std::size_t> &rows);
+    void clearSubsample();
+
+    // Get the error of one expression, returning false if it doesn't compile
+    bool getError(const std::string &expression, double &error);
+    bool getValidationError(const std::string &expression, double &error); // Over the validation rows instead
+
+    // Get methods
+    std::size_t getRowCount() const; // Training rows, whether or not a subsample is used
+    std::size_t getValidationRowCount() const;
+    const std::vector<std::string> &getVariableNames() const;
+    bool isNativeAvailable() const; // Whether phenotypes are being compiled to native code
+
+protected:
+    // Sum of the errors of a phenotype's function over the given rows, which sets isStopped if it stopped past the limit
+    using NativeFunction = double (*)(const float *const *columns, const float *target, std::size_t rowCount, double limit, int *isStopped);
+
+    // A compiled function keeps the object it was loaded from open
+    struct NativeEntry
+    {
+        std::shared_ptr<NativeModule> module;
+        NativeFunction function;
+    };
+
+    // Error measures
+    enum Metric
+    {
+        MSE,
+        RMSE,
+        MAE
+    };
+
+    // Work methods
+    void loadData(const std::string &path, const std::string &targetName);
+    void useRows(const ColumnarDataset::View &rows);
+    void evaluateNative(POPULATIONTYPE &population);
+    void scoreNative(GenomeType &individual, const NativeFunction function, const double limit) const;
+    std::string writeFunction(const std::string &name) const;
+    bool sumError(const std::string &expression, const double limit);
+    double getLimit() const;
+    double getMean(const double sum) const;
+    float getScore(const double error) const;
+
+    // Variables
+    Metric metric;
+    float invalidScore; // Score given to individuals that can't be scored
+    float cutoff;       // Error past which scoring stops, infinite if it never does
+    bool isNative;      // Compile phenotypes to native code
+    std::string nativeCompiler;  // Run directly, so it is one program
+    std::string nativeFlags;     // Split into arguments at spaces
+    std::string nativeDirectory; // Where the source and shared objects are written
+    std::string datasetFile;     // Columnar file of the dataset, next to the CSV file if empty
+    double validationRate;       // Share of the rows held back for validation
+
+    std::vector<std::string> variableNames;
+    std::vector<std::size_t> variableColumns; // Dataset column of each variable
+    std::size_t targetColumn;
+    ColumnarDataset::View training;
+    ColumnarDataset::View validation;
+
+    // Rows of the subsample
+    std::vector<std::vector<float>> sampleColumns;
+    std::vector<float> sampleTarget;
+
+    // Rows individuals are scored on, either the dataset or the subsample
+    std::vector<const float *> columnPointers;
+    const float *targetPointer;
+    std::size_t activeRowCount;
+
+    BytecodeCompiler compiler;
+    BytecodeInterpreter interpreter;
+    Bytecode::Program program; // Kept between individuals to avoid reallocating it
+    IncrementalError errorSum;
+
+    LRUCache<std::uint64_t, NativeEntry> nativeCache;
+    std::vector<std::pair<GenomeType *, std::size_t>> nativeBatch; // Individuals and the function giving their error
+};
+
+// Default constructor
+template <class POPULATIONTYPE>
+BytecodeEvaluator<POPULATIONTYPE>::BytecodeEvaluator()
+    : metric(MSE),
+      invalidScore(std::numeric_limits<float>::max()),
+      cutoff(std::numeric_limits<float>::infinity()),
+      isNative(false),
+      nativeCompiler("cc"),
+      nativeFlags("-O2 -march=native -ffp-contract=off"),
+      nativeDirectory("/tmp"),
+      validationRate(0.0),
+      targetColumn(0),
+      targetPointer(nullptr),
+      activeRowCount(0),
+      nativeCache(4096){};
+
+// Destructor
+template <class POPULATIONTYPE>
+BytecodeEvaluator<POPULATIONTYPE>::~BytecodeEvaluator(){};
+
+// Settings file parsing
+template <class POPULATIONTYPE>
+void BytecodeEvaluator<POPULATIONTYPE>::parseSettings(INIReader &settings)
+{
+    // Get the operators expressions may use, separated by spaces
+    if (settings.HasValue("BytecodeEvaluator", "Operators"))
+    {
+        std::vector<std::string> operators;
+        std::istringstream stream(settings.Get("BytecodeEvaluator", "Operators", ""));
+        std::string name;
+        while (stream >> name)
+        {
+            operators.push_back(name);
+        }
+        compiler.setOperators(operators);
+    }
+
+    // Get the error measure
+    if (settings.HasValue("BytecodeEvaluator", "Metric"))
+    {
+        std::string metric = settings.Get("BytecodeEvaluator", "Metric", "MSE");
+        if (metric == "MSE")
+        {
+            this->metric = MSE;
+        }
+        else if (metric == "RMSE")
+        {
+            this->metric = RMSE;
+        }
+        else if (metric == "MAE")
+        {
+            this->metric = MAE;
+        }
+        else
+        {
+            std::cout << "Error: Invalid BytecodeEvaluator metric. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Get the score given to individuals that can't be scored
+    if (settings.HasValue("BytecodeEvaluator", "InvalidScore"))
+    {
+        this->invalidScore = settings.GetReal("BytecodeEvaluator", "InvalidScore", std::numeric_limits<float>::max());
+    }
+
+    // Get whether phenotypes are compiled to native code, and how
+    if (settings.HasValue("BytecodeEvaluator", "Native"))
+    {
+        this->isNative = settings.GetBoolean("BytecodeEvaluator", "Native", false);
+    }
+
+    if (settings.HasValue("BytecodeEvaluator", "NativeCompiler"))
+    {
+        this->nativeCompiler = settings.Get("BytecodeEvaluator", "NativeCompiler", "cc");
+    }
+
+    if (settings.HasValue("BytecodeEvaluator", "NativeFlags"))
+    {
+        this->nativeFlags = settings.Get("BytecodeEvaluator", "NativeFlags", "");
+    }
+
+    if (settings.HasValue("BytecodeEvaluator", "NativeDirectory"))
+    {
+        this->nativeDirectory = settings.Get("BytecodeEvaluator", "NativeDirectory", "/tmp");
+    }
+    else if (const char *directory = std::getenv("TMPDIR"))
+    {
+        this->nativeDirectory = directory;
+    }
+
+    // Get the number of compiled functions kept
+    if (settings.HasValue("BytecodeEvaluator", "NativeCacheSize"))
+    {
+        long nativeCacheSize = settings.GetInteger("BytecodeEvaluator", "NativeCacheSize", 4096);
+        if (nativeCacheSize < 0)
+        {
+            std::cout << "Error: BytecodeEvaluator native cache size can't be negative. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        nativeCache.setCapacity(nativeCacheSize);
+    }
+
+    // Get where the columnar file of the dataset is kept
+    if (settings.HasValue("BytecodeEvaluator", "DatasetFile"))
+    {
+        this->datasetFile = settings.Get("BytecodeEvaluator", "DatasetFile", "");
+    }
+
+    // Get the share of the rows held back for validation
+    if (settings.HasValue("BytecodeEvaluator", "ValidationRate"))
+    {
+        double validationRate = settings.GetReal("BytecodeEvaluator", "ValidationRate", 0.0);
+        if (validationRate < 0.0 || validationRate >= 1.0)
+        {
+            std::cout << "Error: BytecodeEvaluator validation rate must be at least 0 and below 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->validationRate = validationRate;
+    }
+
+    // Load the dataset, using the last column as the target unless another is named
+    if (settings.HasValue("BytecodeEvaluator", "DataFile"))
+    {
+        loadData(settings.Get("BytecodeEvaluator", "DataFile", ""), settings.Get("BytecodeEvaluator", "Target", ""));
+    }
+    else
+    {
+        std::cout << "Error: BytecodeEvaluator needs a data file. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+// Add command-line arguments
+template <class POPULATIONTYPE>
+void BytecodeEvaluator<POPULATIONTYPE>::addArguments(cxxopts::Options &options){};
+
+// Parse command-line arguments
+template <class POPULATIONTYPE>
+void BytecodeEvaluator<POPULATIONTYPE>::parseArguments(cxxopts::ParseResult &results){};
+
+// Implement pure virtual method from base class
+template <class POPULATIONTYPE>
+bool BytecodeEvaluator<POPULATIONTYPE>::evaluate(POPULATIONTYPE &population)
+{
+    if (isNative)
+    {
+        evaluateNative(population);
+    }
+
+    // Interpret whatever is left
+    double limit = getLimit();
+    for (const GenomePointer &individual : population.individuals)
+    {
+        if (individual->isEvaluated)
+        {
+            continue;
+        }
+
+        individual->isRejected = false;
+        if (individual->isPhenotypeValid && sumError(individual->phenotype, limit))
+        {
+            individual->score = getScore(getMean(errorSum.getSum()));
+            individual->isRejected = errorSum.isStopped();
+        }
+        else
+        {
+            individual->score = invalidScore;
+        }
+        individual->isEvaluated = true;
+    }
+    return true;
+}
+
+template <class POPULATIONTYPE>
+void BytecodeEvaluator<POPULATIONTYPE>::setCutoff(const float cutoff)
+{
+    this->cutoff = cutoff;
+}
+
+template <class POPULATIONTYPE>
+void BytecodeEvaluator<POPULATIONTYPE>::clearCutoff()
+{
+    this->cutoff = std::numeric_limits<float>::infinity();
+}
+
+// Copy the training rows out of the dataset, so they can be run a block at a time like the dataset
+template <class POPULATIONTYPE>
+void BytecodeEvaluator<POPULATIONTYPE>::setSubsample(const std::vector<std::size_t> &rows)
+{
+    sampleColumns.resize(variableColumns.size());
+    for (std::size_t variable = 0; variable < variableColumns.size(); ++variable)
+    {
+        ColumnarDataset::ColumnSpan column = training.getColumn(variableColumns[variable]);
+        sampleColumns[variable].clear();
+        for (std::size_t row : rows)
+        {
+            sampleColumns[variable].push_back(column[row]);
+        }
+        columnPointers[variable] = sampleColumns[variable].data();
+    }
+
+    ColumnarDataset::ColumnSpan target = training.getColumn(targetColumn);
+    sampleTarget.clear();
+    for (std::size_t row : rows)
+    {
+        sampleTarget.push_back(target[row]);
+    }
+    targetPointer = sampleTarget.data();
+    activeRowCount = rows.size();
+}
+
+template <class POPULATIONTYPE>
+void BytecodeEvaluator<POPULATIONTYPE>::clearSubsample()
+{
+    useRows(training);
+}
+
+// Score individuals on the rows of a view, which are read where they are mapped
+template <class POPULATIONTYPE>
+void BytecodeEvaluator<POPULATIONTYPE>::useRows(const ColumnarDataset::View &rows)
+{
+    columnPointers.clear();
+    for (std::size_t column : variableColumns)
+    {
+        columnPointers.push_back(rows.getColumn(column).data);
+    }
+    targetPointer = rows.getColumn(targetColumn).data;
+    activeRowCount = rows.getRowCount();
+}
+
+// The error is found over every row in use
+template <class POPULATIONTYPE>
+bool BytecodeEvaluator<POPULATIONTYPE>::getError(const std::string &expression, double &error)
+{
+    if (!sumError(expression, std::numeric_limits<double>::infinity()))
+    {
+        return false;
+    }
+
+    error = getMean(errorSum.getSum());
+    return true;
+}
+
+// The rows in use are put back afterwards, so a subsample is kept
+template <class POPULATIONTYPE>
+bool BytecodeEvaluator<POPULATIONTYPE>::getValidationError(const std::string &expression, double &error)
+{
+    if (validation.getRowCount() == 0)
+    {
+        return false;
+    }
+
+    std::vector<const float *> activeColumns(columnPointers);
+    const float *activeTarget = targetPointer;
+    std::size_t activeRows = activeRowCount;
+
+    useRows(validation);
+    bool isCompiled = getError(expression, error);
+
+    columnPointers.swap(activeColumns);
+    targetPointer = activeTarget;
+    activeRowCount = activeRows;
+    return isCompiled;
+}
+
+// Compile the expression and add up its errors, stopping past the limit
+template <class POPULATIONTYPE>
+bool BytecodeEvaluator<POPULATIONTYPE>::sumError(const std::string &expression, const double limit)
+{
+    if (!compiler.compile(expression, program))
+    {
+        return false;
+    }
+
+    errorSum.reset(activeRowCount, limit);
+    if (metric == MAE)
+    {
+        interpreter.sumAbsoluteError(program, columnPointers.data(), targetPointer, activeRowCount, errorSum);
+    }
+    else
+    {
+        interpreter.sumSquaredError(program, columnPointers.data(), targetPointer, activeRowCount, errorSum);
+    }
+    return true;
+}
+
+// Compile the phenotypes that aren't cached into one object, then score every phenotype with its function
+// Individuals that aren't scored here are left for the interpreter
+template <class POPULATIONTYPE>
+void BytecodeEvaluator<POPULATIONTYPE>::evaluateNative(POPULATIONTYPE &population)
+{
+    double limit = getLimit();
+    std::vector<NativeFunction> functions;
+    std::vector<std::uint64_t> hashes;
+    std::unordered_map<std::uint64_t, std::size_t> batchIndex; // Function of each phenotype hash
+    std::string source = "#include <math.h>\n"
+                         "#include <stddef.h>\n"
+                         "static inline float grace_min(float a, float b) { return a < b ? a : b; }\n"
+                         "static inline float grace_max(float a, float b) { return a > b ? a : b; }\n";
+
+    nativeBatch.clear();
+    for (const GenomePointer &individual : population.individuals)
+    {
+        if (individual->isEvaluated || !individual->isPhenotypeValid)
+        {
+            continue;
+        }
+
+        if (const NativeEntry *entry = nativeCache.find(individual->phenotypeHash))
+        {
+            scoreNative(*individual, entry->function, limit);
+            continue;
+        }
+
+        // Phenotypes that don't compile are left to the interpreter to score
+        std::pair<typename std::unordered_map<std::uint64_t, std::size_t>::iterator, bool> found = batchIndex.emplace(individual->phenotypeHash, hashes.size());
+        if (found.second)
+        {
+            if (!compiler.compile(individual->phenotype, program))
+            {
+                batchIndex.erase(found.first);
+                continue;
+            }
+            source += writeFunction("grace_phenotype_" + std::to_string(hashes.size()));
+            hashes.push_back(individual->phenotypeHash);
+        }
+        nativeBatch.emplace_back(individual.get(), found.first->second);
+    }
+
+    if (hashes.empty())
+    {
+        return;
+    }
+
+    // Stop compiling for good if the compiler can't be used
+    std::shared_ptr<NativeModule> module(new NativeModule());
+    if (!module->build(source, nativeCompiler, nativeFlags, nativeDirectory))
+    {
+        std::cout << "Warning: Unable to compile phenotypes to native code. Interpreting them instead..." << std::endl;
+        isNative = false;
+        return;
+    }
+
+    for (std::size_t index = 0; index < hashes.size(); ++index)
+    {
+        NativeFunction function = reinterpret_cast<NativeFunction>(module->getSymbol("grace_phenotype_" + std::to_string(index)));
+        functions.push_back(function);
+        if (function)
+        {
+            nativeCache.insert(hashes[index], NativeEntry{module, function});
+        }
+    }
+
+    for (const std::pair<GenomeType *, std::size_t> &entry : nativeBatch)
+    {
+        if (!functions[entry.second])
+        {
+            continue;
+        }
+        scoreNative(*entry.first, functions[entry.second], limit);
+    }
+    nativeBatch.clear();
+}
+
+template <class POPULATIONTYPE>
+void BytecodeEvaluator<POPULATIONTYPE>::scoreNative(GenomeType &individual, const NativeFunction function, const double limit) const
+{
+    int isStopped = 0;
+    individual.score = getScore(getMean(function(columnPointers.data(), targetPointer, activeRowCount, limit, &isStopped)));
+    individual.isRejected = isStopped != 0;
+    individual.isEvaluated = true;
+}
+
+// Write the compiled program as a C function returning its summed error
+// Errors are summed and checked against the limit in the same order as IncrementalError, so the compiler
+// can vectorise the loop without reordering the sum, and the results match the interpreter's exactly
+template <class POPULATIONTYPE>
+std::string BytecodeEvaluator<POPULATIONTYPE>::writeFunction(const std::string &name) const
+{
+    std::string function = "double " + name + "(const float *const *columns, const float *target, size_t rowCount, double limit, int *isStopped)\n{\n";
+    for (std::size_t column = 0; column < variableColumns.size(); ++column)
+    {
+        function += "    const float *column" + std::to_string(column) + " = columns[" + std::to_string(column) + "];\n";
+    }
+
+    std::string lanes = std::to_string(IncrementalError::lanes);
+    std::string checkRows = std::to_string(IncrementalError::checkRows);
+    std::string difference = metric == MAE ? "fabsf(difference)" : "difference * difference";
+    function += "    float lanes[" + lanes + "] = {0};\n"
+                "    size_t laneRows = rowCount - rowCount % " + lanes + ";\n"
+                "    size_t row = 0;\n"
+                "    while (row < laneRows)\n"
+                "    {\n"
+                "        size_t end = row + " + checkRows + " < laneRows ? row + " + checkRows + " : laneRows;\n"
+                "        for (; row < end; row += " + lanes + ")\n"
+                "        {\n"
+                "            for (size_t lane = 0; lane < " + lanes + "; ++lane)\n"
+                "            {\n"
+                "                float difference = " +
+                BytecodeCompiler::toC(program, "row + lane") + " - target[row + lane];\n"
+                "                lanes[lane] += " + difference + ";\n"
+                "            }\n"
+                "        }\n"
+                "        if (row % " + checkRows + " == 0 && row < rowCount)\n"
+                "        {\n"
+                "            double bound = 0.0;\n"
+                "            for (size_t lane = 0; lane < " + lanes + "; ++lane)\n"
+                "            {\n"
+                "                bound += lanes[lane];\n"
+                "            }\n"
+                "            if (bound > limit)\n"
+                "            {\n"
+                "                *isStopped = 1;\n"
+                "                return bound;\n"
+                "            }\n"
+                "        }\n"
+                "    }\n"
+                "    double sum = 0.0;\n"
+                "    for (size_t lane = 0; lane < " + lanes + "; ++lane)\n"
+                "    {\n"
+                "        sum += lanes[lane];\n"
+                "    }\n"
+                "    for (; row < rowCount; ++row)\n"
+                "    {\n"
+                "        float difference = " +
+                BytecodeCompiler::toC(program, "row") + " - target[row];\n"
+                "        sum += " + difference + ";\n"
+                "    }\n"
+                "    return sum;\n"
+                "}\n";
+    return function;
+}
+
+// Turn the cutoff into the sum of errors past which the error is worse than it
+template <class POPULATIONTYPE>
+double BytecodeEvaluator<POPULATIONTYPE>::getLimit() const
+{
+    double limit = metric == RMSE && cutoff > 0.0f ? static_cast<double>(cutoff) * cutoff : cutoff;
+    return limit * activeRowCount;
+}
+
+// Turn a sum of errors into the metric
+template <class POPULATIONTYPE>
+double BytecodeEvaluator<POPULATIONTYPE>::getMean(const double sum) const
+{
+    double mean = sum / activeRowCount;
+    return metric == RMSE ? std::sqrt(mean) : mean;
+}
+
+template <class POPULATIONTYPE>
+float BytecodeEvaluator<POPULATIONTYPE>::getScore(const double error) const
+{
+    return std::isfinite(error) ? error : invalidScore;
+}
+
+// Get methods
+template <class POPULATIONTYPE>
+std::size_t BytecodeEvaluator<POPULATIONTYPE>::getRowCount() const
+{
+    return training.getRowCount();
+}
+
+template <class POPULATIONTYPE>
+std::size_t BytecodeEvaluator<POPULATIONTYPE>::getValidationRowCount() const
+{
+    return validation.getRowCount();
+}
+
+template <class POPULATIONTYPE>
+const std::vector<std::string> &BytecodeEvaluator<POPULATIONTYPE>::getVariableNames() const
+{
+    return variableNames;
+}
+
+template <class POPULATIONTYPE>
+bool BytecodeEvaluator<POPULATIONTYPE>::isNativeAvailable() const
+{
+    return isNative;
+}
+
+// Open the dataset, which is only converted from the CSV file if it has changed
+template <class POPULATIONTYPE>
+void BytecodeEvaluator<POPULATIONTYPE>::loadData(const std::string &path, const std::string &targetName)
+{
+    std::shared_ptr<const ColumnarDataset> dataset = ColumnarDataset::open(path, datasetFile);
+    if (!dataset)
+    {
+        std::cout << "Error: Unable to read BytecodeEvaluator data file. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    const std::vector<std::string> &names = dataset->getNames();
+    targetColumn = targetName.empty() ? names.size() - 1 : dataset->getColumnIndex(targetName);
+    if (names.size() < 2 || targetColumn >= names.size())
+    {
+        std::cout << "Error: BytecodeEvaluator data file has no target column. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // Split the target from the variables
+    variableNames.clear();
+    variableColumns.clear();
+    for (std::size_t column = 0; column < names.size(); ++column)
+    {
+        if (column != targetColumn)
+        {
+            variableNames.push_back(names[column]);
+            variableColumns.push_back(column);
+        }
+    }
+
+    dataset->getView().split(validationRate, training, validation);
+    if (training.getRowCount() == 0)
+    {
+        std::cout << "Error: BytecodeEvaluator data file has no rows. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    clearSubsample();
+
+    compiler.setVariables(variableNames);
+}
+
+#endif
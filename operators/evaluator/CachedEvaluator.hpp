@@ -0,0 +1,326 @@
+#ifndef _CACHEDEVALUATOR_HPP_
+#define _CACHEDEVALUATOR_HPP_
+
+// Include system libraries
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <cstdint>
+
+// Include abstract classes
+#include "../../abstract/Evaluator.hpp"
+
+// Include utility classes
+#include "../../util/LRUCache.hpp"
+#include "../../util/PersistentCache.hpp"
+
+// This template class remembers the scores given by another evaluator.
+// Many genotypes map to the same phenotype, so the same phenotypes are evaluated again and again.
+// Scores are kept in a least recently used cache keyed by the phenotype hash built by the mapper,
+// and an individual whose phenotype is in the cache is given its score without being evaluated.
+// Individuals in the same population with the same phenotype are only evaluated once.
+// Phenotypes are only compared by their 64 bit hash, so the evaluator must always give a phenotype the same score.
+// Scores can also be kept in a file shared by every run of the same problem. Runs then look up
+// scores found by earlier and concurrent runs, and can load them into the cache when they start.
+// Individuals the inner evaluator rejected at a cutoff only have a bound on their score, and individuals scored
+// on less than all the data only have an estimate, so neither are cached.
+template <class POPULATIONTYPE, class EVALUATOR>
+class CachedEvaluator : public Evaluator<POPULATIONTYPE>
+{
+public:
+    // Define types to help readability
+    using GenomeType = typename POPULATIONTYPE::GenomeType;
+    using GenomePointer = typename POPULATIONTYPE::GenomePointer;
+
+    CachedEvaluator();           // Default constructor
+    ~CachedEvaluator() override; // Destructor
+
+    // Command-line & settings file methods
+    void addArguments(cxxopts::Options &) override;
+    void parseArguments(cxxopts::ParseResult &) override;
+    void parseSettings(INIReader &) override;
+
+    // Pass the seed and generation on to the inner evaluator
+    void setRNGSeed(unsigned int seed) override;
+    void setGeneration(std::uint64_t generation) override;
+
+    // Pass the cutoff on to the inner evaluator
+    void setCutoff(const float cutoff) override;
+    void clearCutoff() override;
+
+    // Implement pure virtual method from Evaluator
+    bool evaluate(POPULATIONTYPE &population) override;
+
+    // Get methods
+    EVALUATOR &getEvaluator();
+    unsigned long long getHits() const;   // Individuals given a score without being evaluated
+    unsigned long long getMisses() const; // Individuals that were evaluated
+    unsigned long long getPersistentHits() const; // Hits found in the cache file
+    double getHitRate() const;
+    std::size_t getSize() const;          // Number of cached scores
+
+    // Forget every score cached in memory and reset the hit rate
+    void clear();
+
+protected:
+    // Variables
+    double memoryBudget; // Megabytes used by the cache
+    unsigned long long hits;
+    unsigned long long misses;
+    unsigned long long persistentHits;
+    std::uint64_t problemId; // Identifies the problem's scores in the cache file
+
+    EVALUATOR evaluator;
+    LRUCache<std::uint64_t, float> cache;
+    PersistentCache persistentCache;
+
+    // Buffers kept between generations to avoid reallocating them
+    POPULATIONTYPE uncached;                                   // Individuals given to the inner evaluator
+    std::unordered_map<std::uint64_t, std::size_t> pending;    // Position in uncached of each phenotype hash
+    std::vector<std::pair<GenomeType *, std::size_t>> repeats; // Individuals that take the score of one in uncached
+};
+
+// Default constructor
+template <class POPULATIONTYPE, class EVALUATOR>
+CachedEvaluator<POPULATIONTYPE, EVALUATOR>::CachedEvaluator()
+    : memoryBudget(64.0),
+      hits(0),
+      misses(0),
+      persistentHits(0),
+      problemId(PersistentCache::getProblemId("")),
+      cache(64.0 * 1024 * 1024 / LRUCache<std::uint64_t, float>::entryBytes){};
+
+// Destructor
+template <class POPULATIONTYPE, class EVALUATOR>
+CachedEvaluator<POPULATIONTYPE, EVALUATOR>::~CachedEvaluator(){};
+
+// Settings file parsing
+template <class POPULATIONTYPE, class EVALUATOR>
+void CachedEvaluator<POPULATIONTYPE, EVALUATOR>::parseSettings(INIReader &settings)
+{
+    // Get the memory budget in megabytes, 0 turns the cache off
+    if (settings.HasValue("CachedEvaluator", "MemoryBudget"))
+    {
+        double memoryBudget = settings.GetReal("CachedEvaluator", "MemoryBudget", -1.0);
+        if (memoryBudget < 0.0)
+        {
+            std::cout << "Error: CachedEvaluator memory budget can't be negative. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->memoryBudget = memoryBudget;
+        cache.setCapacity(memoryBudget * 1024 * 1024 / LRUCache<std::uint64_t, float>::entryBytes);
+    }
+
+    // Get the name of the problem, so runs of different problems can share a cache file
+    if (settings.HasValue("CachedEvaluator", "ProblemId"))
+    {
+        this->problemId = PersistentCache::getProblemId(settings.Get("CachedEvaluator", "ProblemId", ""));
+    }
+
+    // Open the cache file
+    if (settings.HasValue("CachedEvaluator", "PersistentFile"))
+    {
+        long capacity = settings.GetInteger("CachedEvaluator", "PersistentCapacity", 1048576);
+        if (capacity < 1)
+        {
+            std::cout << "Error: CachedEvaluator persistent capacity must be at least 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        std::string path = settings.Get("CachedEvaluator", "PersistentFile", "");
+        if (!persistentCache.open(path, capacity))
+        {
+            std::cout << "Error: Unable to open CachedEvaluator persistent file. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+
+        // Start with the problem's scores from earlier runs
+        if (settings.GetBoolean("CachedEvaluator", "WarmStart", true))
+        {
+            persistentCache.forEach(problemId, [this](std::uint64_t hash, float score)
+                                    { cache.insert(hash, score); });
+        }
+    }
+
+    evaluator.parseSettings(settings);
+}
+
+// Add command-line arguments
+template <class POPULATIONTYPE, class EVALUATOR>
+void CachedEvaluator<POPULATIONTYPE, EVALUATOR>::addArguments(cxxopts::Options &options)
+{
+    evaluator.addArguments(options);
+};
+
+// Parse command-line arguments
+template <class POPULATIONTYPE, class EVALUATOR>
+void CachedEvaluator<POPULATIONTYPE, EVALUATOR>::parseArguments(cxxopts::ParseResult &results)
+{
+    evaluator.parseArguments(results);
+};
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void CachedEvaluator<POPULATIONTYPE, EVALUATOR>::setRNGSeed(unsigned int seed)
+{
+    RNG::setRNGSeed(seed);
+    evaluator.setRNGSeed(seed);
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void CachedEvaluator<POPULATIONTYPE, EVALUATOR>::setGeneration(std::uint64_t generation)
+{
+    RNG::setGeneration(generation);
+    evaluator.setGeneration(generation);
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void CachedEvaluator<POPULATIONTYPE, EVALUATOR>::setCutoff(const float cutoff)
+{
+    evaluator.setCutoff(cutoff);
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void CachedEvaluator<POPULATIONTYPE, EVALUATOR>::clearCutoff()
+{
+    evaluator.clearCutoff();
+}
+
+// Implement pure virtual method from base class
+template <class POPULATIONTYPE, class EVALUATOR>
+bool CachedEvaluator<POPULATIONTYPE, EVALUATOR>::evaluate(POPULATIONTYPE &population)
+{
+    uncached.individuals.clear();
+    pending.clear();
+    repeats.clear();
+
+    // Look up every individual that needs a score
+    for (const GenomePointer &individual : population.individuals)
+    {
+        if (individual->isEvaluated)
+        {
+            continue;
+        }
+
+        // Invalid individuals have no phenotype, so the inner evaluator decides their score
+        if (!individual->isPhenotypeValid)
+        {
+            uncached.individuals.push_back(individual);
+            continue;
+        }
+
+        if (const float *score = cache.find(individual->phenotypeHash))
+        {
+            individual->score = *score;
+            individual->isRejected = false;
+            individual->fidelity = 0;
+            individual->isEvaluated = true;
+            ++hits;
+            continue;
+        }
+
+        // Another run may have found the phenotype since this one started
+        float score;
+        if (persistentCache.find(problemId, individual->phenotypeHash, score))
+        {
+            cache.insert(individual->phenotypeHash, score);
+            individual->score = score;
+            individual->isRejected = false;
+            individual->fidelity = 0;
+            individual->isEvaluated = true;
+            ++hits;
+            ++persistentHits;
+            continue;
+        }
+
+        // Only the first individual with each phenotype is evaluated
+        std::pair<typename std::unordered_map<std::uint64_t, std::size_t>::iterator, bool> found = pending.emplace(individual->phenotypeHash, uncached.individuals.size());
+        if (found.second)
+        {
+            uncached.individuals.push_back(individual);
+            ++misses;
+        }
+        else
+        {
+            repeats.emplace_back(individual.get(), found.first->second);
+            ++hits;
+        }
+    }
+
+    // Evaluate the rest, and remember their scores
+    if (!uncached.individuals.empty())
+    {
+        evaluator.evaluate(uncached);
+    }
+
+    for (const GenomePointer &individual : uncached.individuals)
+    {
+        individual->isEvaluated = true;
+        if (individual->isPhenotypeValid && !individual->isRejected && individual->fidelity == 0)
+        {
+            cache.insert(individual->phenotypeHash, individual->score);
+            persistentCache.insert(problemId, individual->phenotypeHash, individual->score);
+        }
+    }
+
+    for (const std::pair<GenomeType *, std::size_t> &repeat : repeats)
+    {
+        repeat.first->score = uncached.individuals[repeat.second]->score;
+        repeat.first->isRejected = uncached.individuals[repeat.second]->isRejected;
+        repeat.first->fidelity = uncached.individuals[repeat.second]->fidelity;
+        repeat.first->isEvaluated = true;
+    }
+
+    // Let go of the individuals so the genome pool can recycle them
+    uncached.individuals.clear();
+    repeats.clear();
+
+    return true;
+}
+
+// Get methods
+template <class POPULATIONTYPE, class EVALUATOR>
+EVALUATOR &CachedEvaluator<POPULATIONTYPE, EVALUATOR>::getEvaluator()
+{
+    return evaluator;
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+unsigned long long CachedEvaluator<POPULATIONTYPE, EVALUATOR>::getHits() const
+{
+    return hits;
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+unsigned long long CachedEvaluator<POPULATIONTYPE, EVALUATOR>::getMisses() const
+{
+    return misses;
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+unsigned long long CachedEvaluator<POPULATIONTYPE, EVALUATOR>::getPersistentHits() const
+{
+    return persistentHits;
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+double CachedEvaluator<POPULATIONTYPE, EVALUATOR>::getHitRate() const
+{
+    return hits + misses > 0 ? static_cast<double>(hits) / (hits + misses) : 0.0;
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+std::size_t CachedEvaluator<POPULATIONTYPE, EVALUATOR>::getSize() const
+{
+    return cache.size();
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void CachedEvaluator<POPULATIONTYPE, EVALUATOR>::clear()
+{
+    cache.clear();
+    hits = 0;
+    misses = 0;
+    persistentHits = 0;
+}
+
+#endif
@@ -0,0 +1,365 @@
+#ifndef _MULTIFIDELITYEVALUATOR_HPP_
+#define _MULTIFIDELITYEVALUATOR_HPP_
+
+// Include system libraries
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <algorithm>
+#include <random>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+
+// Include abstract classes
+#include "../../abstract/Evaluator.hpp"
+
+// This template class screens individuals on a subsample of another evaluator's dataset,
+// and only scores the best of them on the whole dataset.
+// Every individual is scored on the subsample first, then the best fraction of them are scored again on
+// all the rows. Each individual's fidelity records which score it has: 0 for the whole dataset, 1 for the subsample.
+// The subsample is either drawn once, or drawn again every generation so no rows are favoured for long.
+// The inner evaluator must provide getRowCount, setSubsample and clearSubsample, as BytecodeEvaluator does.
+// A cutoff only applies to scores on the whole dataset, so it is passed on for the second pass only.
+// The problem type decides which individuals are promoted, so it has no default and must be given.
+template <class POPULATIONTYPE, class EVALUATOR>
+class MultiFidelityEvaluator : public Evaluator<POPULATIONTYPE>
+{
+public:
+    // Define types to help readability
+    using GenomeType = typename POPULATIONTYPE::GenomeType;
+    using GenomePointer = typename POPULATIONTYPE::GenomePointer;
+
+    static constexpr std::uint8_t subsampleFidelity = 1; // Fidelity of the scores found on the subsample
+
+    MultiFidelityEvaluator();           // Default constructor
+    ~MultiFidelityEvaluator() override; // Destructor
+
+    // Command-line & settings file methods
+    void addArguments(cxxopts::Options &) override;
+    void parseArguments(cxxopts::ParseResult &) override;
+    void parseSettings(INIReader &) override;
+
+    // Pass the seed and generation on to the inner evaluator
+    void setRNGSeed(unsigned int seed) override;
+    void setGeneration(std::uint64_t generation) override;
+
+    // Keep the cutoff for the second pass
+    void setCutoff(const float cutoff) override;
+    void clearCutoff() override;
+
+    // Implement pure virtual method from Evaluator
+    bool evaluate(POPULATIONTYPE &population) override;
+
+    // Get methods
+    EVALUATOR &getEvaluator();
+    const std::vector<std::size_t> &getSample() const; // Rows of the subsample last used
+    unsigned long long getScreened() const;           // Individuals scored on the subsample
+    unsigned long long getPromoted() const;           // Individuals scored again on the whole dataset
+
+protected:
+    // Work methods
+    void drawSample();
+    bool isBetter(const GenomeType &individual, const GenomeType &other) const;
+
+    // Variables
+    double sampleRate;    // Fraction of the rows in the subsample
+    double promotionRate; // Fraction of the screened individuals scored on the whole dataset
+    bool isRotating;      // Draw a new subsample every generation
+    bool isMinimizationProblem;
+    bool hasCutoff;
+    float cutoff;
+    unsigned long long screened;
+    unsigned long long promoted;
+
+    EVALUATOR evaluator;
+    std::vector<std::size_t> sample;
+    std::uint64_t sampleGeneration; // Generation the subsample was drawn for
+
+    // Buffers kept between generations to avoid reallocating them
+    POPULATIONTYPE screening; // Individuals scored on the subsample
+    POPULATIONTYPE promoting; // Individuals scored on the whole dataset
+    std::unordered_map<std::size_t, std::size_t> movedRows; // Rows moved by the partial shuffle, by position
+    std::vector<std::size_t> ranking;
+};
+
+// Default constructor
+template <class POPULATIONTYPE, class EVALUATOR>
+MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::MultiFidelityEvaluator()
+    : sampleRate(0.1),
+      promotionRate(0.2),
+      isRotating(false),
+      isMinimizationProblem(false),
+      hasCutoff(false),
+      cutoff(0.0),
+      screened(0),
+      promoted(0),
+      sampleGeneration(0){};
+
+// Destructor
+template <class POPULATIONTYPE, class EVALUATOR>
+MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::~MultiFidelityEvaluator(){};
+
+// Settings file parsing
+template <class POPULATIONTYPE, class EVALUATOR>
+void MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::parseSettings(INIReader &settings)
+{
+    // Get the fraction of the rows in the subsample
+    if (settings.HasValue("MultiFidelityEvaluator", "SampleRate"))
+    {
+        double sampleRate = settings.GetReal("MultiFidelityEvaluator", "SampleRate", 0.1);
+        if (sampleRate <= 0.0 || sampleRate > 1.0)
+        {
+            std::cout << "Error: MultiFidelityEvaluator sample rate must be above 0 and at most 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->sampleRate = sampleRate;
+    }
+
+    // Get the fraction of the screened individuals scored on the whole dataset
+    if (settings.HasValue("MultiFidelityEvaluator", "PromotionRate"))
+    {
+        double promotionRate = settings.GetReal("MultiFidelityEvaluator", "PromotionRate", 0.2);
+        if (promotionRate < 0.0 || promotionRate > 1.0)
+        {
+            std::cout << "Error: MultiFidelityEvaluator promotion rate must be between 0 and 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->promotionRate = promotionRate;
+    }
+
+    // Get whether the subsample is drawn once or every generation
+    if (settings.HasValue("MultiFidelityEvaluator", "Sample"))
+    {
+        std::string sample = settings.Get("MultiFidelityEvaluator", "Sample", "UNKNOWN");
+
+        if (sample == "fixed")
+        {
+            this->isRotating = false;
+        }
+        else if (sample == "rotating")
+        {
+            this->isRotating = true;
+        }
+        else
+        {
+            std::cout << "Error: Invalid MultiFidelityEvaluator sample. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Get maximization/minimization problem
+    std::string problemType = settings.Get("MultiFidelityEvaluator", "ProblemType", "UNKNOWN");
+
+    if (problemType == "Maximization")
+    {
+        this->isMinimizationProblem = false;
+    }
+    else if (problemType == "Minimization")
+    {
+        this->isMinimizationProblem = true;
+    }
+    else if (!settings.HasValue("MultiFidelityEvaluator", "ProblemType"))
+    {
+        std::cout << "Error: MultiFidelityEvaluator needs a problem type. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    else
+    {
+        std::cout << "Error: Invalid MultiFidelityEvaluator problem type. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    evaluator.parseSettings(settings);
+    sample.clear();
+}
+
+// Add command-line arguments
+template <class POPULATIONTYPE, class EVALUATOR>
+void MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::addArguments(cxxopts::Options &options)
+{
+    evaluator.addArguments(options);
+}
+
+// Parse command-line arguments
+template <class POPULATIONTYPE, class EVALUATOR>
+void MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::parseArguments(cxxopts::ParseResult &results)
+{
+    evaluator.parseArguments(results);
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::setRNGSeed(unsigned int seed)
+{
+    RNG::setRNGSeed(seed);
+    evaluator.setRNGSeed(seed);
+    sample.clear();
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::setGeneration(std::uint64_t generation)
+{
+    RNG::setGeneration(generation);
+    evaluator.setGeneration(generation);
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::setCutoff(const float cutoff)
+{
+    this->hasCutoff = true;
+    this->cutoff = cutoff;
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::clearCutoff()
+{
+    this->hasCutoff = false;
+}
+
+// Implement pure virtual method from base class
+template <class POPULATIONTYPE, class EVALUATOR>
+bool MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::evaluate(POPULATIONTYPE &population)
+{
+    screening.individuals.clear();
+    promoting.individuals.clear();
+    for (const GenomePointer &individual : population.individuals)
+    {
+        if (!individual->isEvaluated)
+        {
+            screening.individuals.push_back(individual);
+        }
+    }
+
+    if (screening.individuals.empty())
+    {
+        return true;
+    }
+
+    // Score every individual on the subsample, where the cutoff doesn't apply
+    if (sample.empty() || (isRotating && sampleGeneration != this->generation))
+    {
+        drawSample();
+    }
+    evaluator.setSubsample(sample);
+    evaluator.clearCutoff();
+    evaluator.evaluate(screening);
+    evaluator.clearSubsample();
+
+    // Individuals without a phenotype have the same score on any rows
+    ranking.clear();
+    for (std::size_t index = 0; index < screening.individuals.size(); ++index)
+    {
+        GenomeType &individual = *screening.individuals[index];
+        individual.isEvaluated = true;
+        individual.fidelity = individual.isPhenotypeValid ? subsampleFidelity : 0;
+        if (individual.isPhenotypeValid)
+        {
+            ranking.push_back(index);
+        }
+    }
+    screened += ranking.size();
+
+    // Find the best, breaking ties by position so the result is reproducible
+    std::size_t promotedCount = std::min(ranking.size(), static_cast<std::size_t>(std::ceil(promotionRate * ranking.size())));
+    std::partial_sort(ranking.begin(), ranking.begin() + promotedCount, ranking.end(), [this](std::size_t a, std::size_t b)
+                      { return isBetter(*screening.individuals[a], *screening.individuals[b]) ||
+                               (!isBetter(*screening.individuals[b], *screening.individuals[a]) && a < b); });
+
+    // Score the best again on the whole dataset
+    for (std::size_t index = 0; index < promotedCount; ++index)
+    {
+        const GenomePointer &individual = screening.individuals[ranking[index]];
+        individual->isEvaluated = false;
+        promoting.individuals.push_back(individual);
+    }
+
+    if (!promoting.individuals.empty())
+    {
+        if (hasCutoff)
+        {
+            evaluator.setCutoff(cutoff);
+        }
+        evaluator.evaluate(promoting);
+
+        for (const GenomePointer &individual : promoting.individuals)
+        {
+            individual->isEvaluated = true;
+            individual->fidelity = 0;
+        }
+        promoted += promoting.individuals.size();
+    }
+
+    // Let go of the individuals so the genome pool can recycle them
+    screening.individuals.clear();
+    promoting.individuals.clear();
+
+    return true;
+}
+
+// Get methods
+template <class POPULATIONTYPE, class EVALUATOR>
+EVALUATOR &MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::getEvaluator()
+{
+    return evaluator;
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+const std::vector<std::size_t> &MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::getSample() const
+{
+    return sample;
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+unsigned long long MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::getScreened() const
+{
+    return screened;
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+unsigned long long MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::getPromoted() const
+{
+    return promoted;
+}
+
+// Draw the rows of the subsample without replacement, in the order they are in the dataset
+// A fixed subsample always uses the first generation's stream, so it doesn't depend on when it is drawn
+template <class POPULATIONTYPE, class EVALUATOR>
+void MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::drawSample()
+{
+    std::size_t rowCount = evaluator.getRowCount();
+    std::size_t sampleSize = std::min(rowCount, std::max<std::size_t>(1, std::llround(sampleRate * rowCount)));
+
+    sampleGeneration = isRotating ? this->generation : 0;
+    CounterRNG rng(this->streamSeed, sampleGeneration);
+
+    // Shuffle only as far as the subsample needs, keeping just the positions that have been swapped,
+    // so the cost depends on the size of the subsample rather than the dataset
+    movedRows.clear();
+    sample.clear();
+    for (std::size_t index = 0; index < sampleSize; ++index)
+    {
+        std::uniform_int_distribution<std::size_t> choice(index, rowCount - 1);
+        std::size_t position = choice(rng);
+
+        auto chosen = movedRows.find(position);
+        auto current = movedRows.find(index);
+        std::size_t row = chosen != movedRows.end() ? chosen->second : position;
+        movedRows[position] = current != movedRows.end() ? current->second : index;
+        sample.push_back(row);
+    }
+
+    std::sort(sample.begin(), sample.end());
+}
+
+// Compare two scores for the problem type, where NaN is worst
+template <class POPULATIONTYPE, class EVALUATOR>
+bool MultiFidelityEvaluator<POPULATIONTYPE, EVALUATOR>::isBetter(const GenomeType &individual, const GenomeType &other) const
+{
+    if (std::isnan(other.score))
+    {
+        return !std::isnan(individual.score);
+    }
+    return isMinimizationProblem ? individual.score < other.score : individual.score > other.score;
+}
+
+#endif
@@ -0,0 +1,420 @@
+#ifndef _PARALLELEVALUATOR_HPP_
+#define _PARALLELEVALUATOR_HPP_
+
+// Include system libraries
+#include <vector>
+#include <memory>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+
+// Include abstract classes
+#include "../../abstract/Evaluator.hpp"
+
+// Include utility classes
+#include "../../util/ThreadPool.hpp"
+
+// This template class evaluates a population in parallel using another evaluator.
+// Each thread has its own copy of the inner evaluator, which is given small batches of individuals.
+// The batches are dealt out to a queue per thread, and a thread that empties its queue
+// steals from the back of another's, so no thread sits idle while there is work left.
+// The batches don't depend on the thread count, and the inner evaluator's generators are reseeded
+// from the first individual's stream before each batch, so scores are the same whichever thread
+// evaluates a batch and however many threads there are.
+// Individuals that are already evaluated are skipped, and invalid individuals are given
+// the invalid score without being evaluated. Optionally the longest phenotypes are evaluated
+// first, so that the slowest evaluations don't end up last.
+template <class POPULATIONTYPE, class EVALUATOR>
+class ParallelEvaluator : public Evaluator<POPULATIONTYPE>
+{
+public:
+    // Define types to help readability
+    using GenomeType = typename POPULATIONTYPE::GenomeType;
+    using GenomePointer = typename POPULATIONTYPE::GenomePointer;
+
+    ParallelEvaluator();           // Default constructor
+    ~ParallelEvaluator() override; // Destructor
+
+    // Command-line & settings file methods
+    void addArguments(cxxopts::Options &) override;
+    void parseArguments(cxxopts::ParseResult &) override;
+    void parseSettings(INIReader &) override;
+
+    // Give the inner evaluators this evaluator's seed and generation
+    void setRNGSeed(unsigned int seed) override;
+    void setGeneration(std::uint64_t generation) override;
+
+    // Pass the cutoff on to the inner evaluators
+    void setCutoff(const float cutoff) override;
+    void clearCutoff() override;
+
+    // Implement pure virtual method from Evaluator
+    bool evaluate(POPULATIONTYPE &population) override;
+
+    // Get methods
+    unsigned int getThreads() const;
+    EVALUATOR &getEvaluator(const unsigned int thread);
+    std::vector<double> getUtilisation() const; // Fraction of the last evaluation each thread spent evaluating
+
+protected:
+    // Queue of batches for one thread
+    // The queue's batches are fixed before the threads start. The range of batches still
+    // to be taken is packed into one word, so the owner can take from the front and
+    // thieves from the back with a single compare and swap
+    struct WorkQueue
+    {
+        std::vector<std::size_t> tasks; // Batch numbers
+        std::atomic<std::uint64_t> range;
+        double busySeconds;
+    };
+
+    // Work methods
+    void runThread(POPULATIONTYPE &population, const unsigned int thread);
+    bool takeFront(WorkQueue &queue, std::size_t &task);
+    bool takeBack(WorkQueue &queue, std::size_t &task);
+    void evaluateBatch(POPULATIONTYPE &population, const unsigned int thread, const std::size_t batchNumber);
+
+    // Variables
+    unsigned int threads;
+    unsigned int batchSize;      // Individuals given to the inner evaluator at a time
+    bool isLongestFirst;         // Evaluate the longest phenotypes first
+    float invalidScore;          // Score given to invalid individuals
+    double lastSeconds;          // Length of the last evaluation
+
+    std::vector<std::unique_ptr<EVALUATOR>> evaluators; // Inner evaluator of each thread
+    std::vector<POPULATIONTYPE> batches;                 // Batch handed to each thread's evaluator
+    std::vector<WorkQueue> queues;
+    std::vector<std::size_t> order;                      // Individuals in the order they are batched
+    std::unique_ptr<ThreadPool> threadPool;
+};
+
+// Default constructor
+// The first inner evaluator is made straight away, so that it can add its command-line arguments
+template <class POPULATIONTYPE, class EVALUATOR>
+ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::ParallelEvaluator()
+    : threads(1),
+      batchSize(1),
+      isLongestFirst(false),
+      invalidScore(0.0),
+      lastSeconds(0.0),
+      batches(1),
+      queues(1)
+{
+    evaluators.emplace_back(new EVALUATOR());
+};
+
+// Destructor
+template <class POPULATIONTYPE, class EVALUATOR>
+ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::~ParallelEvaluator(){};
+
+// Settings file parsing
+template <class POPULATIONTYPE, class EVALUATOR>
+void ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::parseSettings(INIReader &settings)
+{
+    // Get number of threads, 0 uses every hardware thread
+    if (settings.HasValue("ParallelEvaluator", "Threads"))
+    {
+        long threads = settings.GetInteger("ParallelEvaluator", "Threads", 1);
+        if (threads < 0)
+        {
+            std::cout << "Error: Invalid ParallelEvaluator thread count. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    }
+
+    // Get number of individuals given to an inner evaluator at a time
+    if (settings.HasValue("ParallelEvaluator", "BatchSize"))
+    {
+        long batchSize = settings.GetInteger("ParallelEvaluator", "BatchSize", 1);
+        if (batchSize < 1 || batchSize > UINT32_MAX)
+        {
+            std::cout << "Error: ParallelEvaluator batch size must be at least 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->batchSize = batchSize;
+    }
+
+    // Get whether the longest phenotypes are evaluated first
+    if (settings.HasValue("ParallelEvaluator", "LongestFirst"))
+    {
+        this->isLongestFirst = settings.GetBoolean("ParallelEvaluator", "LongestFirst", false);
+    }
+
+    // Get the score given to invalid individuals
+    if (settings.HasValue("ParallelEvaluator", "InvalidScore"))
+    {
+        this->invalidScore = settings.GetReal("ParallelEvaluator", "InvalidScore", 0.0);
+    }
+
+    // Make an inner evaluator for every thread
+    while (evaluators.size() < threads)
+    {
+        evaluators.emplace_back(new EVALUATOR());
+        evaluators.back()->setRNGSeed(this->streamSeed);
+        evaluators.back()->setGeneration(this->generation);
+    }
+    evaluators.resize(threads);
+
+    for (const std::unique_ptr<EVALUATOR> &evaluator : evaluators)
+    {
+        evaluator->parseSettings(settings);
+    }
+
+    // Start the worker threads
+    std::vector<POPULATIONTYPE>(threads).swap(batches);
+    std::vector<WorkQueue>(threads).swap(queues);
+    threadPool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+}
+
+// Add command-line arguments
+// Arguments can only be added once, so only the first inner evaluator adds its own
+template <class POPULATIONTYPE, class EVALUATOR>
+void ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::addArguments(cxxopts::Options &options)
+{
+    evaluators.front()->addArguments(options);
+};
+
+// Parse command-line arguments
+template <class POPULATIONTYPE, class EVALUATOR>
+void ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::parseArguments(cxxopts::ParseResult &results)
+{
+    for (const std::unique_ptr<EVALUATOR> &evaluator : evaluators)
+    {
+        evaluator->parseArguments(results);
+    }
+};
+
+// Every inner evaluator gets the same seed, so their individual streams match
+// Their generators are reseeded before each batch, so they don't share draws
+template <class POPULATIONTYPE, class EVALUATOR>
+void ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::setRNGSeed(unsigned int seed)
+{
+    RNG::setRNGSeed(seed);
+    for (const std::unique_ptr<EVALUATOR> &evaluator : evaluators)
+    {
+        evaluator->setRNGSeed(seed);
+    }
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::setGeneration(std::uint64_t generation)
+{
+    RNG::setGeneration(generation);
+    for (const std::unique_ptr<EVALUATOR> &evaluator : evaluators)
+    {
+        evaluator->setGeneration(generation);
+    }
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::setCutoff(const float cutoff)
+{
+    for (const std::unique_ptr<EVALUATOR> &evaluator : evaluators)
+    {
+        evaluator->setCutoff(cutoff);
+    }
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+void ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::clearCutoff()
+{
+    for (const std::unique_ptr<EVALUATOR> &evaluator : evaluators)
+    {
+        evaluator->clearCutoff();
+    }
+}
+
+// Implement pure virtual method from base class
+template <class POPULATIONTYPE, class EVALUATOR>
+bool ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::evaluate(POPULATIONTYPE &population)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    // Collect the individuals that need evaluating
+    order.clear();
+    for (std::size_t index = 0; index < population.individuals.size(); ++index)
+    {
+        GenomeType &individual = *population.individuals[index];
+        if (individual.isEvaluated)
+        {
+            continue;
+        }
+
+        if (individual.isPhenotypeValid)
+        {
+            order.push_back(index);
+        }
+        else
+        {
+            individual.score = invalidScore;
+            individual.isEvaluated = true;
+        }
+    }
+
+    // Longest phenotypes first, keeping the population order between equal lengths
+    if (isLongestFirst)
+    {
+        std::stable_sort(order.begin(), order.end(), [&population](std::size_t a, std::size_t b)
+                         { return population.individuals[a]->phenotype.size() > population.individuals[b]->phenotype.size(); });
+    }
+
+    // Cut the order into batches, and deal them out in turn so every queue starts with some of the longest
+    std::size_t batchCount = (order.size() + batchSize - 1) / batchSize;
+    for (unsigned int thread = 0; thread < threads; ++thread)
+    {
+        WorkQueue &queue = queues[thread];
+        queue.tasks.clear();
+        for (std::size_t batchNumber = thread; batchNumber < batchCount; batchNumber += threads)
+        {
+            queue.tasks.push_back(batchNumber);
+        }
+        queue.range = queue.tasks.size();
+        queue.busySeconds = 0.0;
+    }
+
+    // Each thread works through its own queue, then steals
+    if (threadPool)
+    {
+        threadPool->parallelFor(threads, 1, [this, &population](std::size_t thread, std::size_t, std::size_t)
+                                { runThread(population, thread); });
+    }
+    else
+    {
+        runThread(population, 0);
+    }
+
+    lastSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// Get methods
+template <class POPULATIONTYPE, class EVALUATOR>
+unsigned int ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::getThreads() const
+{
+    return threads;
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+EVALUATOR &ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::getEvaluator(const unsigned int thread)
+{
+    return *evaluators[thread];
+}
+
+template <class POPULATIONTYPE, class EVALUATOR>
+std::vector<double> ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::getUtilisation() const
+{
+    std::vector<double> utilisation(threads, 0.0);
+    if (lastSeconds > 0.0)
+    {
+        for (unsigned int thread = 0; thread < threads; ++thread)
+        {
+            utilisation[thread] = queues[thread].busySeconds / lastSeconds;
+        }
+    }
+    return utilisation;
+}
+
+// Empty the thread's own queue, then steal batches from the others until every queue is empty
+template <class POPULATIONTYPE, class EVALUATOR>
+void ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::runThread(POPULATIONTYPE &population, const unsigned int thread)
+{
+    std::size_t task;
+
+    while (takeFront(queues[thread], task))
+    {
+        evaluateBatch(population, thread, queues[thread].tasks[task]);
+    }
+
+    for (unsigned int offset = 1; offset < threads; ++offset)
+    {
+        WorkQueue &victim = queues[(thread + offset) % threads];
+        while (takeBack(victim, task))
+        {
+            evaluateBatch(population, thread, victim.tasks[task]);
+        }
+    }
+}
+
+// Take the task at the front of the queue
+// The range keeps the first task in its high word and one past the last in its low word
+template <class POPULATIONTYPE, class EVALUATOR>
+bool ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::takeFront(WorkQueue &queue, std::size_t &task)
+{
+    std::uint64_t range = queue.range.load();
+    while (true)
+    {
+        std::uint64_t first = range >> 32;
+        std::uint64_t last = range & UINT32_MAX;
+        if (first >= last)
+        {
+            return false;
+        }
+
+        if (queue.range.compare_exchange_weak(range, ((first + 1) << 32) | last))
+        {
+            task = first;
+            return true;
+        }
+    }
+}
+
+// Take the task at the back of the queue
+template <class POPULATIONTYPE, class EVALUATOR>
+bool ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::takeBack(WorkQueue &queue, std::size_t &task)
+{
+    std::uint64_t range = queue.range.load();
+    while (true)
+    {
+        std::uint64_t first = range >> 32;
+        std::uint64_t last = range & UINT32_MAX;
+        if (first >= last)
+        {
+            return false;
+        }
+
+        if (queue.range.compare_exchange_weak(range, (first << 32) | (last - 1)))
+        {
+            task = last - 1;
+            return true;
+        }
+    }
+}
+
+// Evaluate a batch of the order with the thread's inner evaluator
+template <class POPULATIONTYPE, class EVALUATOR>
+void ParallelEvaluator<POPULATIONTYPE, EVALUATOR>::evaluateBatch(POPULATIONTYPE &population, const unsigned int thread, const std::size_t batchNumber)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    POPULATIONTYPE &batch = batches[thread];
+    batch.individuals.clear();
+    std::size_t begin = batchNumber * batchSize;
+    std::size_t end = std::min<std::size_t>(begin + batchSize, order.size());
+    for (std::size_t position = begin; position < end; ++position)
+    {
+        batch.individuals.push_back(population.individuals[order[position]]);
+    }
+
+    // Reseed the inner generators from the first individual's stream, so the batch draws
+    // the same numbers on any thread
+    EVALUATOR &evaluator = *evaluators[thread];
+    CounterRNG batchRNG = this->getIndividualRNG(order[begin]);
+    evaluator.rng.seed(static_cast<typename RNG::Engine::result_type>(batchRNG()));
+    evaluator.bulkRng.seed(batchRNG());
+
+    evaluator.evaluate(batch);
+    for (const GenomePointer &individual : batch.individuals)
+    {
+        individual->isEvaluated = true;
+    }
+
+    // Let go of the individuals so the genome pool can recycle them
+    batch.individuals.clear();
+
+    queues[thread].busySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+#endif
@@ -0,0 +1,384 @@
+#ifndef _SUBPROCESSEVALUATOR_HPP_
+#define _SUBPROCESSEVALUATOR_HPP_
+
+// Include system libraries
+#include <vector>
+#include <deque>
+#include <string>
+#include <memory>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <cstdlib>
+#include <poll.h>
+
+// Include abstract classes
+#include "../../abstract/Evaluator.hpp"
+
+// Include utility classes
+#include "../../util/WorkerProcess.hpp"
+
+// This template class scores individuals with an external program.
+// A pool of worker processes is started once and kept running between generations. Each worker reads
+// phenotypes from its standard input, one per line, and writes each one's score on a line of its standard
+// output, in the same order, flushing after every score. Several phenotypes are sent to a worker at once,
+// so it never waits for the next one. A worker that takes longer than the timeout over one phenotype,
+// crashes or gives something other than a number is restarted, the phenotype gets the penalty score,
+// and the phenotypes it hadn't scored yet are sent again. A worker that ended while it had nothing to do is
+// restarted before it is sent anything, and if it ends before it takes a batch the batch is sent again,
+// so only phenotypes a running worker was given are penalised. Invalid individuals get the penalty score
+// without being sent. Newlines in a phenotype are sent as spaces.
+template <class POPULATIONTYPE>
+class SubprocessEvaluator : public Evaluator<POPULATIONTYPE>
+{
+public:
+    // Define types to help readability
+    using GenomeType = typename POPULATIONTYPE::GenomeType;
+    using GenomePointer = typename POPULATIONTYPE::GenomePointer;
+
+    SubprocessEvaluator();           // Default constructor
+    ~SubprocessEvaluator() override; // Destructor
+
+    // Command-line & settings file methods
+    void addArguments(cxxopts::Options &) override;
+    void parseArguments(cxxopts::ParseResult &) override;
+    void parseSettings(INIReader &) override;
+
+    // Implement pure virtual method from Evaluator
+    bool evaluate(POPULATIONTYPE &population) override;
+
+    // Get methods
+    unsigned int getWorkers() const;
+    unsigned long long getRestarts() const; // Workers restarted after failing
+    unsigned long long getFailures() const; // Individuals given the penalty score by a failing worker
+
+protected:
+    using Clock = std::chrono::steady_clock;
+
+    // Phenotypes sent to a worker and not yet scored, oldest first
+    struct Worker
+    {
+        WorkerProcess process;
+        std::deque<GenomeType *> sent;
+        Clock::time_point deadline; // When the oldest phenotype runs out of time
+        bool isHanded;              // Whether the running worker took the oldest phenotype
+    };
+
+    // Work methods
+    void startWorker(Worker &worker);
+    void sendTasks(Worker &worker, const Clock::time_point now);
+    void failWorker(Worker &worker, const bool isTimedOut);
+    bool readScores(Worker &worker, const Clock::time_point now);
+
+    // Variables
+    std::vector<std::string> command;
+    unsigned int workerCount;
+    unsigned int batchSize; // Phenotypes sent to a worker ahead of its replies
+    double timeout;         // Seconds a worker may take over one phenotype
+    float penaltyScore;     // Score given to individuals that can't be scored
+    unsigned long long restarts;
+    unsigned long long failures;
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<GenomeType *> tasks; // Individuals still to be sent, last first
+    std::string line;                // Kept between replies to avoid reallocating it
+};
+
+// Default constructor
+template <class POPULATIONTYPE>
+SubprocessEvaluator<POPULATIONTYPE>::SubprocessEvaluator()
+    : workerCount(1),
+      batchSize(16),
+      timeout(10.0),
+      penaltyScore(0.0),
+      restarts(0),
+      failures(0){};
+
+// Destructor
+template <class POPULATIONTYPE>
+SubprocessEvaluator<POPULATIONTYPE>::~SubprocessEvaluator(){};
+
+// Settings file parsing
+template <class POPULATIONTYPE>
+void SubprocessEvaluator<POPULATIONTYPE>::parseSettings(INIReader &settings)
+{
+    // Get the worker command and its arguments, separated by spaces
+    std::istringstream stream(settings.Get("SubprocessEvaluator", "Command", ""));
+    std::string argument;
+    command.clear();
+    while (stream >> argument)
+    {
+        command.push_back(argument);
+    }
+
+    if (command.empty())
+    {
+        std::cout << "Error: SubprocessEvaluator needs a command. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // Get number of workers, 0 uses every hardware thread
+    if (settings.HasValue("SubprocessEvaluator", "Workers"))
+    {
+        long workerCount = settings.GetInteger("SubprocessEvaluator", "Workers", 1);
+        if (workerCount < 0)
+        {
+            std::cout << "Error: Invalid SubprocessEvaluator worker count. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->workerCount = workerCount == 0 ? std::max(1u, std::thread::hardware_concurrency()) : workerCount;
+    }
+
+    // Get number of phenotypes sent to a worker ahead of its replies
+    if (settings.HasValue("SubprocessEvaluator", "BatchSize"))
+    {
+        long batchSize = settings.GetInteger("SubprocessEvaluator", "BatchSize", 16);
+        if (batchSize < 1)
+        {
+            std::cout << "Error: SubprocessEvaluator batch size must be at least 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->batchSize = batchSize;
+    }
+
+    // Get the seconds a worker may take over one phenotype
+    if (settings.HasValue("SubprocessEvaluator", "Timeout"))
+    {
+        double timeout = settings.GetReal("SubprocessEvaluator", "Timeout", 10.0);
+        if (timeout <= 0.0)
+        {
+            std::cout << "Error: SubprocessEvaluator timeout must be positive. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->timeout = timeout;
+    }
+
+    // Get the score given to individuals that can't be scored
+    if (settings.HasValue("SubprocessEvaluator", "PenaltyScore"))
+    {
+        this->penaltyScore = settings.GetReal("SubprocessEvaluator", "PenaltyScore", 0.0);
+    }
+
+    // Start the workers
+    workers.clear();
+    for (unsigned int index = 0; index < workerCount; ++index)
+    {
+        workers.emplace_back(new Worker());
+        startWorker(*workers.back());
+    }
+}
+
+// Add command-line arguments
+template <class POPULATIONTYPE>
+void SubprocessEvaluator<POPULATIONTYPE>::addArguments(cxxopts::Options &options){};
+
+// Parse command-line arguments
+template <class POPULATIONTYPE>
+void SubprocessEvaluator<POPULATIONTYPE>::parseArguments(cxxopts::ParseResult &results){};
+
+// Implement pure virtual method from base class
+// Keep every worker's batch full, and wait for replies or the next deadline
+template <class POPULATIONTYPE>
+bool SubprocessEvaluator<POPULATIONTYPE>::evaluate(POPULATIONTYPE &population)
+{
+    // Collect the individuals to send, in population order
+    tasks.clear();
+    for (auto individual = population.individuals.rbegin(); individual != population.individuals.rend(); ++individual)
+    {
+        if ((*individual)->isEvaluated)
+        {
+            continue;
+        }
+
+        if ((*individual)->isPhenotypeValid)
+        {
+            tasks.push_back(individual->get());
+        }
+        else
+        {
+            (*individual)->score = penaltyScore;
+            (*individual)->isEvaluated = true;
+        }
+    }
+
+    std::vector<pollfd> descriptors(workers.size());
+    while (true)
+    {
+        Clock::time_point now = Clock::now();
+        bool isBusy = false;
+        Clock::time_point nextDeadline = Clock::time_point::max();
+
+        for (std::size_t index = 0; index < workers.size(); ++index)
+        {
+            Worker &worker = *workers[index];
+            sendTasks(worker, now);
+
+            descriptors[index].fd = worker.process.getDescriptor();
+            descriptors[index].events = POLLIN | (worker.process.hasPendingOutput() ? POLLOUT : 0);
+            descriptors[index].revents = 0;
+
+            if (!worker.sent.empty())
+            {
+                isBusy = true;
+                nextDeadline = std::min(nextDeadline, worker.deadline);
+            }
+        }
+
+        if (!isBusy)
+        {
+            break;
+        }
+
+        // Wait for a worker, rounding the wait up so a deadline has passed when it ends
+        int wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextDeadline - now).count() + 1;
+        poll(descriptors.data(), descriptors.size(), std::max(wait, 0));
+
+        now = Clock::now();
+        for (std::size_t index = 0; index < workers.size(); ++index)
+        {
+            Worker &worker = *workers[index];
+            bool isWorking = true;
+
+            if (descriptors[index].revents & POLLOUT)
+            {
+                isWorking = worker.process.flush();
+            }
+
+            if (isWorking && descriptors[index].revents & (POLLIN | POLLHUP | POLLERR))
+            {
+                isWorking = readScores(worker, now);
+            }
+
+            bool isTimedOut = isWorking && !worker.sent.empty() && now >= worker.deadline;
+            if (!isWorking || isTimedOut)
+            {
+                failWorker(worker, isTimedOut);
+            }
+        }
+    }
+    return true;
+}
+
+// Get methods
+template <class POPULATIONTYPE>
+unsigned int SubprocessEvaluator<POPULATIONTYPE>::getWorkers() const
+{
+    return workerCount;
+}
+
+template <class POPULATIONTYPE>
+unsigned long long SubprocessEvaluator<POPULATIONTYPE>::getRestarts() const
+{
+    return restarts;
+}
+
+template <class POPULATIONTYPE>
+unsigned long long SubprocessEvaluator<POPULATIONTYPE>::getFailures() const
+{
+    return failures;
+}
+
+template <class POPULATIONTYPE>
+void SubprocessEvaluator<POPULATIONTYPE>::startWorker(Worker &worker)
+{
+    if (!worker.process.start(command))
+    {
+        std::cout << "Error: Unable to start SubprocessEvaluator worker. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+    worker.isHanded = false;
+}
+
+// Fill the worker's batch, starting the clock on its oldest phenotype if it was idle
+template <class POPULATIONTYPE>
+void SubprocessEvaluator<POPULATIONTYPE>::sendTasks(Worker &worker, const Clock::time_point now)
+{
+    bool wasIdle = worker.sent.empty();
+
+    // A worker that ended while it was idle failed no phenotype, so it is only restarted
+    if (wasIdle && !tasks.empty() && worker.process.hasExited())
+    {
+        startWorker(worker);
+        ++restarts;
+    }
+
+    while (worker.sent.size() < batchSize && !tasks.empty())
+    {
+        GenomeType *individual = tasks.back();
+        tasks.pop_back();
+
+        line = individual->phenotype;
+        std::replace(line.begin(), line.end(), '\n', ' ');
+        worker.process.send(line);
+        worker.sent.push_back(individual);
+    }
+
+    if (wasIdle && !worker.sent.empty())
+    {
+        worker.deadline = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(timeout));
+    }
+
+    // An idle worker has read everything it was sent, so a running one always takes the start of a new batch
+    // A worker that has gone is noticed when its socket hangs up
+    bool isFlushed = worker.process.flush();
+    if (wasIdle)
+    {
+        worker.isHanded = isFlushed;
+    }
+}
+
+// Give the phenotype the worker was on the penalty score, and send the rest again after restarting it
+// The phenotype is only penalised if it ran out of time, or if the worker was running when it took it
+template <class POPULATIONTYPE>
+void SubprocessEvaluator<POPULATIONTYPE>::failWorker(Worker &worker, const bool isTimedOut)
+{
+    if (!worker.sent.empty() && (isTimedOut || worker.isHanded))
+    {
+        worker.sent.front()->score = penaltyScore;
+        worker.sent.front()->isEvaluated = true;
+        worker.sent.pop_front();
+        ++failures;
+    }
+
+    while (!worker.sent.empty())
+    {
+        tasks.push_back(worker.sent.back());
+        worker.sent.pop_back();
+    }
+
+    startWorker(worker);
+    ++restarts;
+}
+
+// Score the oldest phenotypes with the worker's replies, returning false if the worker has failed
+template <class POPULATIONTYPE>
+bool SubprocessEvaluator<POPULATIONTYPE>::readScores(Worker &worker, const Clock::time_point now)
+{
+    bool isOpen = worker.process.receive();
+
+    while (worker.process.nextLine(line))
+    {
+        // A reply nothing asked for, or one that isn't a number, means the worker can't be trusted
+        if (worker.sent.empty())
+        {
+            return false;
+        }
+
+        char *end;
+        float score = std::strtof(line.c_str(), &end);
+        if (end == line.c_str() || line.find_first_not_of(" \t\r", end - line.c_str()) != std::string::npos)
+        {
+            return false;
+        }
+
+        worker.sent.front()->score = score;
+        worker.sent.front()->isEvaluated = true;
+        worker.sent.pop_front();
+        worker.isHanded = true;
+        worker.deadline = now + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(timeout));
+    }
+    return isOpen;
+}
+
+#endif
@@ -46,7 +46,7 @@ protected:
     unsigned int populationSize;
     // unsigned int sensibleMinDepth;
     unsigned int sensibleMaxDepth;
-    CFGrammar grammarFile;
+    std::shared_ptr<CFGrammar> grammarFile; // Shared with every initialised individual
 
 private:
     // Method pointer is private so that the prototype can be changed in the derived class
@@ -65,11 +65,12 @@ private:
 
 // Default constructor
 template <class POPULATIONTYPE>
-GEInitialiser<POPULATIONTYPE>::GEInitialiser() : method(&GEInitialiser::random),
-                                                 populationSize(100),
-                                                 genomeMinLength(50),
+GEInitialiser<POPULATIONTYPE>::GEInitialiser() : genomeMinLength(50),
                                                  genomeMaxLength(100),
-                                                 sensibleMaxDepth(25){};
+                                                 populationSize(100),
+                                                 sensibleMaxDepth(25),
+                                                 grammarFile(std::make_shared<CFGrammar>()),
+                                                 method(&GEInitialiser::random){};
 
 // Destructor
 template <class POPULATIONTYPE>
@@ -113,7 +114,7 @@ void GEInitialiser<POPULATIONTYPE>::parseSettings(INIReader &settings)
             std::cout << "Error: Invalid GEInitialiser grammar filename. Exiting..." << std::endl;
             exit(EXIT_FAILURE);
         }
-        this->grammarFile.readBNFFile(grammarFile);
+        this->grammarFile->readBNFFile(grammarFile);
     }
 
     // Get initial population size
@@ -188,7 +189,7 @@ void GEInitialiser<POPULATIONTYPE>::parseArguments(cxxopts::ParseResult &results
     }
     if (results.count("bnfgrammar"))
     {
-        this->grammarFile.readBNFFile(results["bnfgrammar"].as<std::string>());
+        this->grammarFile->readBNFFile(results["bnfgrammar"].as<std::string>());
     }
 };
 
@@ -206,7 +207,7 @@ bool GEInitialiser<POPULATIONTYPE>::random(POPULATIONTYPE &population)
     for (unsigned int i = 0; i < this->populationSize; ++i)
     {
         // Add new individual to population
-        GenomePointer individual = std::make_shared<GenomeType>();
+        GenomePointer individual = population.createGenome();
 
         // Initialise the individual
         createRandom(*individual);
@@ -228,7 +229,7 @@ bool GEInitialiser<POPULATIONTYPE>::rvd(POPULATIONTYPE &population)
     for (unsigned int i = 0; i < this->populationSize; ++i)
     {
         // Add new individual to population
-        GenomePointer individual = std::make_shared<GenomeType>();
+        GenomePointer individual = population.createGenome();
 
         // Initialise the individual
         createRandom(*individual);
@@ -279,7 +280,7 @@ bool GEInitialiser<POPULATIONTYPE>::sensible(POPULATIONTYPE &population)
     }
 
     // Get minimum depth for start symbol
-    unsigned int minimumDepth = grammarFile.getStartRule()->getMinimumDepth();
+    unsigned int minimumDepth = grammarFile->getStartRule()->getMinimumDepth();
 
     // Get range of depths - Min and Max inbetween
     if (minimumDepth > sensibleMaxDepth)
@@ -322,7 +323,7 @@ bool GEInitialiser<POPULATIONTYPE>::sensible(POPULATIONTYPE &population)
             for (int i = 0; i < 2; ++i)
             {
                 // Create individual
-                GenomePointer individual = std::make_shared<GenomeType>();
+                GenomePointer individual = population.createGenome();
 
                 // Add the grammar to the individual
                 individual->grammar = this->grammarFile;
@@ -355,7 +356,7 @@ bool GEInitialiser<POPULATIONTYPE>::sensible(POPULATIONTYPE &population)
         unsigned int depth = depths.at(depthDistribution(this->rng));
 
         // Create individual
-        GenomePointer individual = std::make_shared<GenomeType>();
+        GenomePointer individual = population.createGenome();
 
         // Add the grammar to the individual
         individual->grammar = this->grammarFile;
@@ -386,19 +387,16 @@ bool GEInitialiser<POPULATIONTYPE>::sensible(POPULATIONTYPE &population)
 template <class POPULATIONTYPE>
 bool GEInitialiser<POPULATIONTYPE>::createRandom(GenomeType &individual)
 {
-    // Select our range to generate codons in (0-255)
-    std::uniform_int_distribution<> codonDistribution(0, UINT8_MAX);
     std::uniform_int_distribution<> genomeLengthDistribution(this->genomeMinLength, this->genomeMaxLength);
 
     // Choose a random length
     unsigned int genomeLength = genomeLengthDistribution(this->rng);
 
-    // Initialise genotype
-    for (unsigned int j = 0; j < genomeLength; ++j)
-    {
-        // TODO: Maybe replace this rand function?
-        individual.genotype.push_back(codonDistribution(this->rng));
-    }
+    // Initialise genotype, generating the codons (0-255) in one go
+    Genotype::Codons &codons = individual.genotype.modify();
+    std::size_t start = codons.size();
+    codons.resize(start + genomeLength);
+    this->bulkRng.fillCodons(codons.data() + start, genomeLength);
 
     return true;
 }
@@ -410,7 +408,7 @@ bool GEInitialiser<POPULATIONTYPE>::createTree(GenomeType &individual, int maxDe
 {
     // Call recursive function with the start symbol
     // Derivation tree starts at a depth of 0 for the root node
-    return createSubTree(individual, maxDepth, type, *individual.grammar.getStartSymbol(), 0);
+    return createSubTree(individual, maxDepth, type, *individual.grammar->getStartSymbol(), 0);
 }
 
 // Generate codons for the selected level of the derivation tree
@@ -430,7 +428,7 @@ bool GEInitialiser<POPULATIONTYPE>::createSubTree(GenomeType &individual, int ma
     }
 
     // Symbol is a non-terminal. Get the corrosponding rule
-    const CFRule *currentRule = individual.grammar.findRule(currentSymbol);
+    const CFRule *currentRule = individual.grammar->findRule(currentSymbol);
 
     // Was the rule found?
     if (currentRule == nullptr)
@@ -561,21 +559,18 @@ bool GEInitialiser<POPULATIONTYPE>::createSubTree(GenomeType &individual, int ma
 template <class POPULATIONTYPE>
 bool GEInitialiser<POPULATIONTYPE>::createTail(GenomeType &individual)
 {
-    // Select our range to generate codons in (0-255)
     // TODO: Make whether tails are added or not clearer. (Negative won't add, make this explicit)
-    std::uniform_int_distribution<> codonDistribution(0, UINT8_MAX);
-
     // Make sure the length is in the correct range
     std::uniform_int_distribution<> genomeLengthDistribution(this->genomeMinLength - individual.genotype.size(), this->genomeMaxLength - individual.genotype.size());
 
     // Choose a random length
     unsigned int genomeLength = genomeLengthDistribution(this->rng);
 
-    // Initialise genotype
-    for (unsigned int j = 0; j < genomeLength; ++j)
-    {
-        individual.genotype.push_back(codonDistribution(this->rng));
-    }
+    // Add the codons (0-255) in one go
+    Genotype::Codons &codons = individual.genotype.modify();
+    std::size_t start = codons.size();
+    codons.resize(start + genomeLength);
+    this->bulkRng.fillCodons(codons.data() + start, genomeLength);
 
     return true;
 }
@@ -1,9 +1,15 @@
 #ifndef _GEMAPPER_HPP_
 #define _GEMAPPER_HPP_
 
+// Include system libraries
+#include <string>
+#include <cstdint>
+#include <algorithm>
+
 // Include abstract classes
 #include "../../abstract/Mapper.hpp"
 #include "../../grammar/CFGrammar.hpp"
+#include "../../util/GenomePool.hpp"
 
 // This template class provides mapping methods that work
 // with all classes that inherit GEGenome
@@ -35,6 +41,12 @@ protected:
     int maxWrappingEvents;
     int currentWrappingEvents;
 
+    // Derivation trees are recycled once no genome holds them, and their nodes' children buffers
+    // are kept for the next trees' nodes. Spare buffers beyond what a mapping takes are freed
+    GenomePool<DerivationTree> treePool;
+    DerivationTree::ChildrenBuffers childrenBuffers;
+    std::size_t takenBuffers; // Nodes given children during the current mapping
+
 private:
     // Method pointer is private so that the prototype can be changed in the derived class
     // Note that this only hides the CrossoverMethod variable.
@@ -43,7 +55,8 @@ private:
     MapperMethod method;
 
     // Work methods
-    bool addChildrenNodes(DerivationTree &currentNode, GenomeType &genome, std::vector<unsigned int>::iterator &genotypeIt, bool buildDerivationTree);
+    static std::uint64_t hashTerminal(std::uint64_t hash, const std::string &terminal);
+    bool addChildrenNodes(DerivationTree &currentNode, GenomeType &genome, Genotype::const_iterator &genotypeIt, bool buildDerivationTree);
     bool mapGenotypeToPhenotype(GenomeType &genome, const bool buildDerivationTree);
 };
 
@@ -52,7 +65,8 @@ template <class POPULATIONTYPE>
 GEMapper<POPULATIONTYPE>::GEMapper()
     : method(&GEMapper::mapper),
       maxWrappingEvents(0),
-      currentWrappingEvents(0){};
+      currentWrappingEvents(0),
+      takenBuffers(0){};
 
 // Destructor
 template <class POPULATIONTYPE>
@@ -127,9 +141,20 @@ template <class POPULATIONTYPE>
 bool GEMapper<POPULATIONTYPE>::mapper(POPULATIONTYPE &population)
 {
     // For each individual, call the mapping method
+    // Keep track of the fewest spare buffers there were, as that many were never needed
+    std::size_t unusedBuffers = childrenBuffers.size();
+    takenBuffers = 0;
     for (std::shared_ptr<GenomeType> &individual : population.individuals)
     {
         mapGenotypeToPhenotype(*individual, true);
+        unusedBuffers = std::min(unusedBuffers, childrenBuffers.size());
+    }
+
+    // Buffers are taken from the back, so the unused ones are at the front
+    // As many are kept as the mapping took, so the next one can need more without allocating
+    if (unusedBuffers > takenBuffers)
+    {
+        childrenBuffers.erase(childrenBuffers.begin(), childrenBuffers.begin() + (unusedBuffers - takenBuffers));
     }
 
     return true;
@@ -137,11 +162,11 @@ bool GEMapper<POPULATIONTYPE>::mapper(POPULATIONTYPE &population)
 
 // Recursive function that adds the child nodes to the current node of the derivation tree
 template <class POPULATIONTYPE>
-bool GEMapper<POPULATIONTYPE>::addChildrenNodes(DerivationTree &currentNode, GenomeType &genome, std::vector<unsigned int>::iterator &genotypeIt, bool buildDerivationTree)
+bool GEMapper<POPULATIONTYPE>::addChildrenNodes(DerivationTree &currentNode, GenomeType &genome, Genotype::const_iterator &genotypeIt, bool buildDerivationTree)
 {
     // Find the rule for the given symbol
     Symbol const *currentSymbol = &*currentNode.getData();
-    CFRule const *rulePtr = genome.grammar.findRule(*currentSymbol);
+    CFRule const *rulePtr = genome.grammar->findRule(*currentSymbol);
 
     // Safety Checks
     // Does the rule exist?
@@ -198,14 +223,20 @@ bool GEMapper<POPULATIONTYPE>::addChildrenNodes(DerivationTree &currentNode, Gen
         chosenChoice = &rulePtr->rhs.at(0);
     }
 
+    // Reserve the child nodes so that adding a sibling never copies the subtrees already mapped
+    currentNode.reserveChildren(chosenChoice->symbols.size(), childrenBuffers);
+    ++takenBuffers;
+
     // For each symbol in the current choice
     for (Choice::Symbols::const_iterator symbIt = chosenChoice->symbols.begin(); symbIt < chosenChoice->symbols.end(); ++symbIt)
     {
         // Is the symbol a terminal?
         if ((*symbIt)->getType() == Symbol::TerminalSymbol)
         {
-            // Add terminal string to phenotype
-            genome.phenotype.append((*symbIt)->getValue());
+            // Add terminal string to phenotype, and to the phenotype's hash
+            const std::string terminal = (*symbIt)->getValue();
+            genome.phenotype.append(terminal);
+            genome.phenotypeHash = hashTerminal(genome.phenotypeHash, terminal);
 
             // Add terminal to derivation tree
             currentNode.children.push_back(*symbIt);
@@ -250,6 +281,18 @@ bool GEMapper<POPULATIONTYPE>::addChildrenNodes(DerivationTree &currentNode, Gen
     return true;
 }
 
+// Add a terminal to an FNV-1a hash, so the phenotype is hashed as it is built
+template <class POPULATIONTYPE>
+std::uint64_t GEMapper<POPULATIONTYPE>::hashTerminal(std::uint64_t hash, const std::string &terminal)
+{
+    for (const char character : terminal)
+    {
+        hash ^= static_cast<unsigned char>(character);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
 template <class POPULATIONTYPE>
 bool GEMapper<POPULATIONTYPE>::mapGenotypeToPhenotype(GenomeType &genome, const bool buildDerivationTree)
 {
@@ -264,7 +307,7 @@ bool GEMapper<POPULATIONTYPE>::mapGenotypeToPhenotype(GenomeType &genome, const
     }
 
     // Is the grammar valid?
-    if (!genome.grammar.getValidGrammar())
+    if (!genome.grammar || !genome.grammar->getValidGrammar())
     {
         // Grammar invalid, return failure
         return false;
@@ -275,6 +318,7 @@ bool GEMapper<POPULATIONTYPE>::mapGenotypeToPhenotype(GenomeType &genome, const
 
     // Clear the existing phenotype and invalidate the phenotype
     genome.phenotype.clear();
+    genome.phenotypeHash = 14695981039346656037ULL;
     genome.isPhenotypeValid = false;
 
     // Does the genome contain at least one codon?
@@ -284,20 +328,20 @@ bool GEMapper<POPULATIONTYPE>::mapGenotypeToPhenotype(GenomeType &genome, const
         return false;
     }
 
-    // Reset the derivation tree
-    genome.derivationTree.children.clear();
-    genome.derivationTree.setData(genome.grammar.getStartSymbol());
-    genome.derivationTree.setCurrentLevel(0);
+    // Take a new derivation tree, as the old one may be shared with other genomes
+    genome.derivationTree = treePool.acquire(childrenBuffers);
+    genome.derivationTree->setData(genome.grammar->getStartSymbol());
+    genome.derivationTree->setCurrentLevel(0);
 
     // TODO: Check is this is necessary
     // genome.derivationTree.setDepth(1);
 
     // Get a pointer to the start of the genotype
     // This is required to know which codon to look at while mapping the children nodes
-    std::vector<unsigned int>::iterator genoIt = genome.genotype.begin();
+    Genotype::const_iterator genoIt = genome.genotype.begin();
 
     // Add all children nodes to the start symbol - This will fully map the individual
-    bool wasMapSuccessful = addChildrenNodes(genome.derivationTree, genome, genoIt, false);
+    bool wasMapSuccessful = addChildrenNodes(*genome.derivationTree, genome, genoIt, false);
 
     // The genome is valid if the mapping was successful
     genome.isPhenotypeValid = wasMapSuccessful;
@@ -1,9 +1,17 @@
 #ifndef _GEMUTATION_HPP_
 #define _GEMUTATION_HPP_
 
+// Include system libraries
+#include <random>
+#include <algorithm>
+#include <memory>
+
 // Include abstract classes
 #include "../../abstract/Mutation.hpp"
 
+// Include utility classes
+#include "../../util/ParallelChunks.hpp"
+
 // This template class provides crossover methods that work
 // with all classes that inherit GEGenome
 template <class POPULATIONTYPE>
@@ -32,6 +40,11 @@ protected:
 
     // Variables
     float rate;
+    bool isEffectiveRegionOnly; // Only mutate the codons used by the mapper
+    ParallelChunks parallelChunks; // Runs the work over large populations on worker threads
+
+    // Work methods
+    void codonGenome(GenomeType &individual, CounterRNG &rng);
 
 private:
     // Method pointer is private so that the prototype can be changed in the derived class
@@ -45,7 +58,9 @@ private:
 template <class POPULATIONTYPE>
 GEMutation<POPULATIONTYPE>::GEMutation()
     : method(&GEMutation::codon),
-      rate(0.05){};
+      rate(0.05),
+      isEffectiveRegionOnly(false),
+      parallelChunks(256, 1024){};
 
 // Destructor
 template <class POPULATIONTYPE>
@@ -85,6 +100,15 @@ void GEMutation<POPULATIONTYPE>::parseSettings(INIReader &settings)
             exit(1);
         }
     }
+
+    // Get effective region flag
+    if (settings.HasValue("GEMutation", "EffectiveRegionOnly"))
+    {
+        this->isEffectiveRegionOnly = settings.GetBoolean("GEMutation", "EffectiveRegionOnly", false);
+    }
+
+    // Get the threads used for large populations
+    parallelChunks.parseSettings(settings, "GEMutation");
 }
 
 // Add command-line arguments
@@ -118,33 +142,78 @@ bool GEMutation<POPULATIONTYPE>::mutate(POPULATIONTYPE &population)
 };
 
 // Codon mutation
+// Each individual is mutated with its own random stream, so the result doesn't depend on the order they are mutated in
 template <class POPULATIONTYPE>
 bool GEMutation<POPULATIONTYPE>::codon(POPULATIONTYPE &population)
+{
+    if (this->rate <= 0.0)
+    {
+        return true;
+    }
+
+    // For each individual in the population
+    parallelChunks.run(population.individuals.size(), [this, &population](std::size_t begin, std::size_t end, std::size_t)
+                       {
+                           for (std::size_t i = begin; i < end; ++i)
+                           {
+                               CounterRNG rng = this->getIndividualRNG(i);
+                               codonGenome(*population.individuals[i], rng);
+                           }
+                       });
+    return true;
+}
+
+// Each codon is mutated with probability rate. Rather than rolling for every codon,
+// the gap to the next mutated codon is drawn from a geometric distribution,
+// so the number of random numbers drawn is proportional to the number of mutations
+template <class POPULATIONTYPE>
+void GEMutation<POPULATIONTYPE>::codonGenome(GenomeType &individual, CounterRNG &rng)
 {
     // Set distribution ranges
+    // A rate of 1 mutates every codon, which the geometric distribution doesn't allow
+    bool isEveryCodon = this->rate >= 1.0;
     std::uniform_int_distribution<> codonDistibution(0, UINT8_MAX);
-    std::uniform_real_distribution<> mutationProbability(0, 1);
+    std::geometric_distribution<std::size_t> gapDistribution(isEveryCodon ? 0.5 : this->rate);
 
-    // For each individual in the population
-    for (std::shared_ptr<GenomeType> &individual : population.individuals)
+    // Codons shared with another genome are only copied once a mutation happens
+    Genotype &genotype = individual.genotype;
+
+    // Codons past the effective region aren't read by the mapper, so mutating them has no effect
+    std::size_t end = genotype.size();
+    if (isEffectiveRegionOnly && individual.effectiveSize > 0)
     {
-        // For each codon in the individual
-        for (unsigned int &codon : individual->genotype)
-        {
-            // Select a number between 0 & 1
-            float result = mutationProbability(this->rng);
+        end = std::min<std::size_t>(end, individual.effectiveSize);
+    }
 
-            // If the result is less than the mutation rate
-            if (result < this->rate)
-            {
-                // Mutate the current codon
-                codon = codonDistibution(this->rng);
-            }
+    // Skip to each mutated codon, remembering the first one
+    std::size_t index = 0;
+    std::size_t firstMutation = end;
+    while (true)
+    {
+        std::size_t gap = isEveryCodon ? 0 : gapDistribution(rng);
+        if (gap >= end - index)
+        {
+            break;
+        }
+        index += gap;
 
-            // Otherwise, move onto the next codon
+        // Mutate the current codon
+        genotype.set(index, codonDistibution(rng));
+        if (firstMutation == end)
+        {
+            firstMutation = index;
         }
+        ++index;
+    }
+
+    // Invalidate the individual if a codon read by the mapper has changed
+    // Mutations past the effective region of a valid individual leave its phenotype and score unchanged
+    bool isMutated = firstMutation < end;
+    if (isMutated && (!individual.isPhenotypeValid || firstMutation < individual.effectiveSize))
+    {
+        individual.isPhenotypeValid = false;
+        individual.isEvaluated = false;
     }
-    return true;
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -1,12 +1,31 @@
 #ifndef _FLOATREPLACEMENT_HPP_
 #define _FLOATREPLACEMENT_HPP_
 
+// Include system libraries
+#include <vector>
+#include <random>
+#include <cstdint>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <algorithm>
+#include <string>
+#include <functional>
+#include <unordered_set>
+#include <unordered_map>
+
 // Include abstract classes
 #include "../../abstract/Replacement.hpp"
 #include "../../population/FloatPopulation.hpp"
 
+// Include utility classes
+#include "../../util/ThreadPool.hpp"
+#include "../../util/IndexedHeap.hpp"
+
 // This template class provides replacement methods that work
 // with all classes that inherit FloatGenome
+// Scores are only compared at the same fidelity, and a score found on all the data beats one found on less of it
 template <class POPULATIONTYPE = FloatPopulation>
 class FloatReplacement : public Replacement<POPULATIONTYPE>
 {
@@ -25,13 +44,82 @@ public:
     // Implement pure virtual method from Replacement
     bool replace(POPULATIONTYPE &population, POPULATIONTYPE &children) override;
 
+    // In steady state replacement with the cutoff on, children worse than the worst individual are dropped
+    bool getCutoff(POPULATIONTYPE &population, float &cutoff) override;
+
 protected:
     // Available replacement methods
     bool generational(POPULATIONTYPE &population, POPULATIONTYPE &children);
+    bool steadyState(POPULATIONTYPE &population, POPULATIONTYPE &children);
 
     // Variables
     float elitismRate;
     bool isMinimizationProblem;
+    unsigned int threads;            // Threads used to read the scores
+    std::size_t parallelThreshold;   // Scores are read in parallel from this many individuals
+    bool isVictimTournament;         // Only used by steady state replacement, otherwise the worst is replaced
+    unsigned int victimTournamentSize;
+    bool isPhenotypeKey;             // Duplicates have the same phenotype, otherwise the same effective codons
+    bool isCutoff;                   // Only used by steady state replacement, otherwise children always replace their victim
+
+    // How individuals that duplicate a better one are treated
+    enum DuplicateHandling
+    {
+        KeepDuplicates,   // Duplicates are treated like any other individual
+        SkipDuplicates,   // Duplicates are only used if no unique children or parents are left
+        DemoteDuplicates  // Duplicate children are ranked after the unique children
+    };
+    DuplicateHandling duplicateHandling;
+
+    // Scores are read in chunks of this size
+    static constexpr std::size_t chunkSize = 4096;
+
+    // Score of an individual, where lower is better, its position and its fidelity
+    struct RankKey
+    {
+        float score;
+        unsigned int index;
+        std::uint8_t fidelity;
+    };
+
+    // Fitness of an individual, where higher is better, ordered by fidelity first
+    struct Fitness
+    {
+        float value;
+        std::uint8_t fidelity;
+
+        bool operator<(const Fitness &other) const
+        {
+            return fidelity > other.fidelity || (fidelity == other.fidelity && value < other.value);
+        }
+    };
+
+    // Work methods
+    void moveBestToFront(Individuals &individuals, const std::size_t count);
+    bool generationalUnique(POPULATIONTYPE &population, POPULATIONTYPE &children);
+    void getKeys(const Individuals &individuals, std::vector<RankKey> &ranking);
+    void sortBest(std::vector<RankKey> &ranking, std::size_t &sortedCount, const std::size_t count);
+    void takeUnique(const Individuals &individuals, std::vector<RankKey> &ranking, std::size_t &sortedCount, std::size_t &position,
+                    std::vector<unsigned int> &duplicates, Individuals &next, const std::size_t limit);
+    std::size_t getHash(const GenomeType &individual) const;
+    static bool isBetterKey(const RankKey &a, const RankKey &b);
+    Fitness getFitness(const GenomeType &individual) const;
+    std::size_t getVictim();
+    void updateHeap(POPULATIONTYPE &population);
+
+    // Buffers kept between generations to avoid reallocating them
+    std::vector<RankKey> keys;
+    std::vector<RankKey> childKeys;
+    std::vector<char> isChosen;
+    std::unordered_set<std::size_t> hashes;                  // Hashes of the individuals chosen so far
+    std::unordered_map<std::size_t, unsigned int> hashCounts; // Hashes in the population, kept between steady state steps
+    std::vector<unsigned int> parentDuplicates;
+    std::vector<unsigned int> childDuplicates;
+    std::unique_ptr<ThreadPool> threadPool;
+
+    // Heap of the population's fitness with the worst individual on top, kept between steady state steps
+    IndexedHeap<Fitness> worstHeap;
+    std::vector<Fitness> fitnesses;
 
 private:
     // Method pointer is private so that the prototype can be changed in the derived class
@@ -39,10 +127,6 @@ private:
     // TODO: Template this so that the definition can change correctly.
     typedef bool (FloatReplacement::*ReplacementMethod)(POPULATIONTYPE &population, POPULATIONTYPE &children);
     ReplacementMethod method;
-
-    // Methods for sorting individuals
-    static bool sortIndividualMax(const GenomePointer &a, const GenomePointer &b);
-    static bool sortIndividualMin(const GenomePointer &a, const GenomePointer &b);
 };
 
 // Default constructor
@@ -50,7 +134,14 @@ template <class POPULATIONTYPE>
 FloatReplacement<POPULATIONTYPE>::FloatReplacement()
     : method(&FloatReplacement::generational),
       elitismRate(0.1),
-      isMinimizationProblem(false){};
+      isMinimizationProblem(false),
+      threads(1),
+      parallelThreshold(16384),
+      isVictimTournament(false),
+      victimTournamentSize(2),
+      isPhenotypeKey(false),
+      isCutoff(false),
+      duplicateHandling(KeepDuplicates){};
 
 // Destructor
 template <class POPULATIONTYPE>
@@ -69,6 +160,10 @@ void FloatReplacement<POPULATIONTYPE>::parseSettings(INIReader &settings)
         {
             this->method = &FloatReplacement::generational;
         }
+        else if (method == "steadyState")
+        {
+            this->method = &FloatReplacement::steadyState;
+        }
         else
         {
             std::cout << "Error: Invalid FloatReplacement method name. Exiting..." << std::endl;
@@ -109,6 +204,115 @@ void FloatReplacement<POPULATIONTYPE>::parseSettings(INIReader &settings)
             exit(EXIT_FAILURE);
         }
     }
+
+    // Get number of threads, 0 uses every hardware thread
+    if (settings.HasValue("FloatReplacement", "Threads"))
+    {
+        long threads = settings.GetInteger("FloatReplacement", "Threads", 1);
+        if (threads < 0)
+        {
+            std::cout << "Error: Invalid FloatReplacement thread count. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    }
+
+    // Get population size from which scores are read in parallel
+    if (settings.HasValue("FloatReplacement", "ParallelThreshold"))
+    {
+        long parallelThreshold = settings.GetInteger("FloatReplacement", "ParallelThreshold", 16384);
+        if (parallelThreshold < 1)
+        {
+            std::cout << "Error: FloatReplacement parallel threshold must be at least 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->parallelThreshold = parallelThreshold;
+    }
+
+    // Get the individual replaced by each child in steady state replacement
+    if (settings.HasValue("FloatReplacement", "Victim"))
+    {
+        std::string victim = settings.Get("FloatReplacement", "Victim", "UNKNOWN");
+
+        if (victim == "worst")
+        {
+            this->isVictimTournament = false;
+        }
+        else if (victim == "tournament")
+        {
+            this->isVictimTournament = true;
+        }
+        else
+        {
+            std::cout << "Error: Invalid FloatReplacement victim. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Get the number of individuals in a victim tournament
+    if (settings.HasValue("FloatReplacement", "VictimTournamentSize"))
+    {
+        long victimTournamentSize = settings.GetInteger("FloatReplacement", "VictimTournamentSize", 2);
+        if (victimTournamentSize < 1)
+        {
+            std::cout << "Error: FloatReplacement victim tournament size must be at least 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->victimTournamentSize = victimTournamentSize;
+    }
+
+    // Get how duplicates are treated
+    if (settings.HasValue("FloatReplacement", "Duplicates"))
+    {
+        std::string duplicates = settings.Get("FloatReplacement", "Duplicates", "UNKNOWN");
+
+        if (duplicates == "keep")
+        {
+            this->duplicateHandling = KeepDuplicates;
+        }
+        else if (duplicates == "skip")
+        {
+            this->duplicateHandling = SkipDuplicates;
+        }
+        else if (duplicates == "demote")
+        {
+            this->duplicateHandling = DemoteDuplicates;
+        }
+        else
+        {
+            std::cout << "Error: Invalid FloatReplacement duplicates option. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Get what makes two individuals duplicates
+    if (settings.HasValue("FloatReplacement", "DuplicateKey"))
+    {
+        std::string duplicateKey = settings.Get("FloatReplacement", "DuplicateKey", "UNKNOWN");
+
+        if (duplicateKey == "genotype")
+        {
+            this->isPhenotypeKey = false;
+        }
+        else if (duplicateKey == "phenotype")
+        {
+            this->isPhenotypeKey = true;
+        }
+        else
+        {
+            std::cout << "Error: Invalid FloatReplacement duplicate key. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Get whether steady state replacement drops children worse than the whole population
+    if (settings.HasValue("FloatReplacement", "Cutoff"))
+    {
+        this->isCutoff = settings.GetBoolean("FloatReplacement", "Cutoff", false);
+    }
+
+    // Start the worker threads
+    threadPool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
 }
 
 // Implement pure virtual method from base class
@@ -118,59 +322,345 @@ bool FloatReplacement<POPULATIONTYPE>::replace(POPULATIONTYPE &population, POPUL
     return (this->*method)(population, children);
 };
 
+// A child that is worse than the worst individual would only take its place, so it isn't needed
+// Putting children in only ever improves the worst individual, so the cutoff holds until the children are put in
+template <class POPULATIONTYPE>
+bool FloatReplacement<POPULATIONTYPE>::getCutoff(POPULATIONTYPE &population, float &cutoff)
+{
+    if (!isCutoff || method != &FloatReplacement::steadyState || population.individuals.empty())
+    {
+        return false;
+    }
+
+    // Any child scored on all the data beats an individual scored on less of it
+    updateHeap(population);
+    Fitness fitness = worstHeap.getKey(worstHeap.top());
+    if (fitness.fidelity != 0 || std::isinf(fitness.value))
+    {
+        return false;
+    }
+
+    cutoff = isMinimizationProblem ? -fitness.value : fitness.value;
+    return true;
+}
+
 // Generational replacement - Add best elites and children
+// Only the elites and the children that are kept are found, in O(N) rather than by sorting both populations
 template <class POPULATIONTYPE>
 bool FloatReplacement<POPULATIONTYPE>::generational(POPULATIONTYPE &population, POPULATIONTYPE &children)
 {
-    // Used to store the next population
-    POPULATIONTYPE newPopulation;
+    // Get number of individuals to keep with elitism, and the number of children needed for the rest
+    std::size_t populationSize = population.individuals.size();
+    std::size_t elitismSize = floor(populationSize * elitismRate);
+    std::size_t childrenSize = populationSize - elitismSize;
 
-    // Sort populations depending on problem type
-    if (isMinimizationProblem)
+    if (children.individuals.size() < childrenSize)
     {
-        std::sort(std::begin(population.individuals), std::end(population.individuals), sortIndividualMin);
-        std::sort(std::begin(children.individuals), std::end(children.individuals), sortIndividualMin);
+        std::cout << "Error: Not enough children to fill the population. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
     }
-    else
+
+    if (duplicateHandling != KeepDuplicates)
+    {
+        return generationalUnique(population, children);
+    }
+
+    // Move the elites to the front of the population, and the best children to the front of the children
+    moveBestToFront(population.individuals, elitismSize);
+    moveBestToFront(children.individuals, childrenSize);
+
+    // Swap the children into the population after the elites
+    // The individuals that are replaced are released with the children
+    std::swap_ranges(children.individuals.begin(), children.individuals.begin() + childrenSize, population.individuals.begin() + elitismSize);
+
+    return true;
+}
+
+// Steady state replacement - Each child replaces the worst individual, or the loser of a tournament
+// The population's fitness is kept in a heap, so finding the worst takes O(1) and each replacement O(log N)
+template <class POPULATIONTYPE>
+bool FloatReplacement<POPULATIONTYPE>::steadyState(POPULATIONTYPE &population, POPULATIONTYPE &children)
+{
+    updateHeap(population);
+
+    if (population.individuals.empty())
+    {
+        return true;
+    }
+
+    // Put each child in place of its victim
+    for (const GenomePointer &child : children.individuals)
     {
-        std::sort(std::begin(population.individuals), std::end(population.individuals), sortIndividualMax);
-        std::sort(std::begin(children.individuals), std::end(children.individuals), sortIndividualMax);
+        // Children that were rejected at the cutoff, or are worse than every individual, are dropped with the cutoff on
+        if (isCutoff && (child->isRejected || getFitness(*child) < worstHeap.getKey(worstHeap.top())))
+        {
+            continue;
+        }
+
+        // Children already in the population are dropped
+        std::size_t hash = 0;
+        if (duplicateHandling != KeepDuplicates)
+        {
+            hash = getHash(*child);
+            if (hashCounts.count(hash) != 0)
+            {
+                continue;
+            }
+        }
+
+        std::size_t victim = getVictim();
+
+        if (duplicateHandling != KeepDuplicates)
+        {
+            auto victimHash = hashCounts.find(getHash(*population.individuals[victim]));
+            if (--victimHash->second == 0)
+            {
+                hashCounts.erase(victimHash);
+            }
+            ++hashCounts[hash];
+        }
+
+        population.individuals[victim] = child;
+        worstHeap.update(victim, getFitness(*child));
     }
 
-    // Make sure our new population is the correct size
-    newPopulation.individuals.resize(population.individuals.size());
+    return true;
+}
 
-    // Get number of individuals to keep with elitism
-    int elitismSize = floor(population.individuals.size() * elitismRate);
+// Rebuild the heap if the population has changed size, which includes the first step
+template <class POPULATIONTYPE>
+void FloatReplacement<POPULATIONTYPE>::updateHeap(POPULATIONTYPE &population)
+{
+    std::size_t populationSize = population.individuals.size();
+    if (worstHeap.size() != populationSize)
+    {
+        fitnesses.resize(populationSize);
+        for (std::size_t index = 0; index < populationSize; ++index)
+        {
+            fitnesses[index] = getFitness(*population.individuals[index]);
+        }
+        worstHeap.assign(fitnesses);
 
-    // Add the elites
-    for (int i = 0; i < elitismSize; ++i)
+        // Count the hashes in the population
+        hashCounts.clear();
+        if (duplicateHandling != KeepDuplicates)
+        {
+            for (const GenomePointer &individual : population.individuals)
+            {
+                ++hashCounts[getHash(*individual)];
+            }
+        }
+    }
+}
+
+// Choose the individual replaced by a child in steady state replacement
+template <class POPULATIONTYPE>
+std::size_t FloatReplacement<POPULATIONTYPE>::getVictim()
+{
+    if (!isVictimTournament)
     {
-        newPopulation.individuals.at(i) = population.individuals.at(i);
+        return worstHeap.top();
     }
 
-    // Add the children
-    for (int i = elitismSize; i < population.individuals.size(); ++i)
+    // The loser of the tournament is the victim
+    std::uniform_int_distribution<std::size_t> choice(0, worstHeap.size() - 1);
+    std::size_t victim = choice(this->rng);
+    for (unsigned int round = 1; round < victimTournamentSize; ++round)
     {
-        newPopulation.individuals.at(i) = children.individuals.at(i - elitismSize);
+        std::size_t challenger = choice(this->rng);
+        if (worstHeap.getKey(challenger) < worstHeap.getKey(victim))
+        {
+            victim = challenger;
+        }
     }
 
-    // Set the population to the new population
-    population = newPopulation;
+    return victim;
+}
+
+// Get a fitness from a score, where higher is better for both problem types and NaN is worst
+template <class POPULATIONTYPE>
+typename FloatReplacement<POPULATIONTYPE>::Fitness FloatReplacement<POPULATIONTYPE>::getFitness(const GenomeType &individual) const
+{
+    if (std::isnan(individual.score))
+    {
+        return {-std::numeric_limits<float>::infinity(), individual.fidelity};
+    }
+    return {isMinimizationProblem ? -individual.score : individual.score, individual.fidelity};
+}
+
+// Generational replacement without duplicates
+// The elites are the best unique parents, followed by the best children that duplicate neither the elites nor each other.
+// When skipping duplicates, the best of the other unique parents take the place of duplicate children.
+// Duplicates are only used when there is nothing else left.
+// The individuals are only ordered as far as they are needed, so with few duplicates this costs about as much
+// as generational replacement with duplicates
+template <class POPULATIONTYPE>
+bool FloatReplacement<POPULATIONTYPE>::generationalUnique(POPULATIONTYPE &population, POPULATIONTYPE &children)
+{
+    std::size_t populationSize = population.individuals.size();
+    std::size_t elitismSize = floor(populationSize * elitismRate);
+
+    // Get the scores of both populations
+    getKeys(population.individuals, keys);
+    getKeys(children.individuals, childKeys);
+    std::size_t parentsSorted = 0, parentPosition = 0;
+    std::size_t childrenSorted = 0, childPosition = 0;
+
+    hashes.clear();
+    parentDuplicates.clear();
+    childDuplicates.clear();
+
+    // Used to store the next population, allocated alongside the children
+    Individuals next(children.getResource());
+    next.reserve(populationSize);
+
+    // Add the elites and then the children
+    takeUnique(population.individuals, keys, parentsSorted, parentPosition, parentDuplicates, next, elitismSize);
+    takeUnique(children.individuals, childKeys, childrenSorted, childPosition, childDuplicates, next, populationSize);
+
+    // Fill the places of duplicate children with unique parents
+    if (duplicateHandling == SkipDuplicates)
+    {
+        takeUnique(population.individuals, keys, parentsSorted, parentPosition, parentDuplicates, next, populationSize);
+    }
+
+    // Use the duplicates if there are not enough unique individuals
+    for (std::size_t duplicate = 0; duplicate < childDuplicates.size() && next.size() < populationSize; ++duplicate)
+    {
+        next.push_back(children.individuals[childDuplicates[duplicate]]);
+    }
+    for (std::size_t duplicate = 0; duplicate < parentDuplicates.size() && next.size() < populationSize; ++duplicate)
+    {
+        next.push_back(population.individuals[parentDuplicates[duplicate]]);
+    }
+
+    // Swap the next population into place
+    std::swap_ranges(next.begin(), next.end(), population.individuals.begin());
 
     return true;
 }
 
+// Add the individuals in order of score until next reaches the limit, recording the duplicates instead of adding them
+// Position is the next key to look at, and the keys are sorted in growing windows as they are needed
 template <class POPULATIONTYPE>
-bool FloatReplacement<POPULATIONTYPE>::sortIndividualMax(const GenomePointer &a, const GenomePointer &b)
+void FloatReplacement<POPULATIONTYPE>::takeUnique(const Individuals &individuals, std::vector<RankKey> &ranking, std::size_t &sortedCount, std::size_t &position,
+                                                  std::vector<unsigned int> &duplicates, Individuals &next, const std::size_t limit)
 {
-    return a->score > b->score;
+    while (next.size() < limit && position < ranking.size())
+    {
+        // Sort enough keys for the rest of the individuals, doubling the window each time it runs out
+        if (position == sortedCount)
+        {
+            sortBest(ranking, sortedCount, position + std::max(limit - next.size(), sortedCount));
+        }
+
+        unsigned int index = ranking[position++].index;
+        if (hashes.insert(getHash(*individuals[index])).second)
+        {
+            next.push_back(individuals[index]);
+        }
+        else
+        {
+            duplicates.push_back(index);
+        }
+    }
+}
+
+// Get the key of each individual
+template <class POPULATIONTYPE>
+void FloatReplacement<POPULATIONTYPE>::getKeys(const Individuals &individuals, std::vector<RankKey> &ranking)
+{
+    std::size_t size = individuals.size();
+    ranking.resize(size);
+
+    auto getChunkKeys = [this, &individuals, &ranking](std::size_t begin, std::size_t end, std::size_t)
+    {
+        for (std::size_t index = begin; index < end; ++index)
+        {
+            Fitness fitness = getFitness(*individuals[index]);
+            ranking[index] = {-fitness.value, static_cast<unsigned int>(index), fitness.fidelity};
+        }
+    };
+
+    if (threadPool && size >= parallelThreshold)
+    {
+        threadPool->parallelFor(size, chunkSize, getChunkKeys);
+    }
+    else
+    {
+        getChunkKeys(0, size, 0);
+    }
+}
+
+// Sort the best keys after the ones already sorted, so that the first count keys are in order
+template <class POPULATIONTYPE>
+void FloatReplacement<POPULATIONTYPE>::sortBest(std::vector<RankKey> &ranking, std::size_t &sortedCount, const std::size_t count)
+{
+    std::size_t end = std::min(count, ranking.size());
+    if (end > sortedCount)
+    {
+        std::partial_sort(ranking.begin() + sortedCount, ranking.begin() + end, ranking.end(), isBetterKey);
+        sortedCount = end;
+    }
+}
+
+// Get the hash that identifies duplicates
+// Invalid individuals have no phenotype, so they are always compared by their codons
+template <class POPULATIONTYPE>
+std::size_t FloatReplacement<POPULATIONTYPE>::getHash(const GenomeType &individual) const
+{
+    if (isPhenotypeKey && individual.isPhenotypeValid)
+    {
+        return individual.phenotypeHash;
+    }
+
+    // Only the codons used by the mapper affect the phenotype
+    std::size_t count = individual.isPhenotypeValid && individual.effectiveSize > 0 ? individual.effectiveSize : individual.genotype.size();
+    return individual.genotype.hash(count);
+}
+
+// Order keys by fidelity then score, breaking ties by position so the result is reproducible
+template <class POPULATIONTYPE>
+bool FloatReplacement<POPULATIONTYPE>::isBetterKey(const RankKey &a, const RankKey &b)
+{
+    if (a.fidelity != b.fidelity)
+    {
+        return a.fidelity < b.fidelity;
+    }
+    return a.score < b.score || (a.score == b.score && a.index < b.index);
 }
 
+// Move the best count individuals to the front, in no particular order
+// The scores are copied into a contiguous buffer first, so the partitioning never follows the genome pointers
 template <class POPULATIONTYPE>
-bool FloatReplacement<POPULATIONTYPE>::sortIndividualMin(const GenomePointer &a, const GenomePointer &b)
+void FloatReplacement<POPULATIONTYPE>::moveBestToFront(Individuals &individuals, const std::size_t count)
 {
-    return a->score < b->score;
+    std::size_t size = individuals.size();
+    if (count == 0 || count >= size)
+    {
+        return;
+    }
+
+    getKeys(individuals, keys);
+
+    // Find the best keys
+    std::nth_element(keys.begin(), keys.begin() + count, keys.end(), isBetterKey);
+
+    // Move the chosen individuals to the front in a single pass
+    isChosen.assign(size, false);
+    for (std::size_t key = 0; key < count; ++key)
+    {
+        isChosen[keys[key].index] = true;
+    }
+
+    std::size_t front = 0;
+    for (std::size_t index = 0; index < size; ++index)
+    {
+        if (isChosen[index])
+        {
+            std::swap(individuals[front++], individuals[index]);
+        }
+    }
 }
 
 #endif
@@ -3,11 +3,21 @@
 
 // Include system libraries
 #include <random>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <memory>
+#include <thread>
 
 // Include abstract classes
 #include "../../abstract/Selection.hpp"
 #include "../../population/FloatPopulation.hpp"
 
+// Include utility classes
+#include "../../util/ThreadPool.hpp"
+
 // This template class provides selection methods that work
 // with all classes that inherit GEGenome
 template <class POPULATIONTYPE = FloatPopulation>
@@ -18,6 +28,8 @@ public:
     using GenomeType = typename POPULATIONTYPE::GenomeType;
     using GenomePointer = typename POPULATIONTYPE::GenomePointer;
     using Individuals = typename POPULATIONTYPE::Individuals;
+    using Indices = typename POPULATIONTYPE::Indices;
+    using Engine = RNG::Engine;
 
     FloatSelection();           // Default constructor
     ~FloatSelection() override; // Destructor
@@ -25,21 +37,58 @@ public:
     // Settings file methods
     void parseSettings(INIReader &) override;
 
-    bool select(POPULATIONTYPE &population, POPULATIONTYPE &parents) override;
+    bool select(POPULATIONTYPE &population, Indices &parents) override;
 
 protected:
     // Available selection methods
-    bool rouletteWheelSelection(POPULATIONTYPE &population, POPULATIONTYPE &parents);
+    bool rouletteWheelSelection(POPULATIONTYPE &population, Indices &parents);
+    bool stochasticUniversalSampling(POPULATIONTYPE &population, Indices &parents);
+    bool tournamentSelection(POPULATIONTYPE &population, Indices &parents);
+    bool linearRankSelection(POPULATIONTYPE &population, Indices &parents);
+    bool exponentialRankSelection(POPULATIONTYPE &population, Indices &parents);
 
     // Variable
-    bool replacementEnabled;
+    bool replacementEnabled; // Only used by roulette wheel selection
     bool isMinimizationProblem;
+    unsigned int tournamentSize;     // Only used by tournament selection
+    double selectionPressure;        // Only used by linear rank selection, between 1 and 2
+    double rankBase;                 // Only used by exponential rank selection, between 0 and 1
+    unsigned int threads;            // Threads used to draw the parents
+    std::size_t parallelThreshold;   // Parents are drawn in chunks from this many parents
+
+    // Parents are drawn in chunks of this size, each chunk with its own random stream,
+    // so the parents don't depend on the number of threads
+    static constexpr std::size_t chunkSize = 4096;
+
+    // Work methods
+    void getCandidates(POPULATIONTYPE &population, const Indices &parents);
+    void getCandidateWeights(POPULATIONTYPE &population, const Indices &parents);
+    void rankCandidates(POPULATIONTYPE &population);
+    bool rankSelection(POPULATIONTYPE &population, Indices &parents);
+    void buildAliasTable();
+    template <class ENGINE>
+    unsigned int drawAliasTable(ENGINE &rng) const;
+    void selectWithoutReplacement(Indices &parents);
+    template <class DRAW>
+    void drawParents(Indices &parents, DRAW draw);
+    bool isBetter(const float score, const float other) const;
+
+    // Buffers kept between generations to avoid reallocating them
+    std::vector<unsigned int> candidates;                 // Indices of valid individuals
+    std::vector<double> weights;                          // Selection weight of each candidate
+    std::vector<double> aliasProbabilities;               // Alias table - Probability of keeping a column
+    std::vector<unsigned int> aliasIndices;               // Alias table - Candidate taken otherwise
+    std::vector<unsigned int> smallColumns;               // Alias table construction work lists
+    std::vector<unsigned int> largeColumns;
+    std::vector<std::pair<double, unsigned int>> sampleKeys; // Keys for sampling without replacement
+    std::size_t rankTableSize;                            // Number of ranks in the alias table, 0 if not built
+    std::unique_ptr<ThreadPool> threadPool;
 
 private:
     // Method pointer is private so that the prototype can be changed in the derived class
     // Note that this only hides the CrossoverMethod variable.
     // TODO: Template this so that the definition can change correctly.
-    typedef bool (FloatSelection::*SelectionMethod)(POPULATIONTYPE &population, POPULATIONTYPE &parents);
+    typedef bool (FloatSelection::*SelectionMethod)(POPULATIONTYPE &population, Indices &parents);
     SelectionMethod method;
 };
 
@@ -47,7 +96,14 @@ private:
 template <class POPULATIONTYPE>
 FloatSelection<POPULATIONTYPE>::FloatSelection()
     : method(&FloatSelection::rouletteWheelSelection),
-      replacementEnabled(true){};
+      replacementEnabled(true),
+      isMinimizationProblem(false),
+      tournamentSize(2),
+      selectionPressure(1.5),
+      rankBase(0.9),
+      threads(1),
+      parallelThreshold(16384),
+      rankTableSize(0){};
 
 // Destructor
 template <class POPULATIONTYPE>
@@ -66,6 +122,22 @@ void FloatSelection<POPULATIONTYPE>::parseSettings(INIReader &settings)
         {
             this->method = &FloatSelection::rouletteWheelSelection;
         }
+        else if (method == "sus")
+        {
+            this->method = &FloatSelection::stochasticUniversalSampling;
+        }
+        else if (method == "tournament")
+        {
+            this->method = &FloatSelection::tournamentSelection;
+        }
+        else if (method == "linearRank")
+        {
+            this->method = &FloatSelection::linearRankSelection;
+        }
+        else if (method == "exponentialRank")
+        {
+            this->method = &FloatSelection::exponentialRankSelection;
+        }
         else
         {
             std::cout << "Error: Invalid FloatSelection method name. Exiting..." << std::endl;
@@ -100,34 +172,243 @@ void FloatSelection<POPULATIONTYPE>::parseSettings(INIReader &settings)
         bool replacementEnabled = settings.GetBoolean("FloatSelection", "Replacement", false);
         this->replacementEnabled = replacementEnabled;
     }
+
+    // Get tournament size
+    if (settings.HasValue("FloatSelection", "TournamentSize"))
+    {
+        long tournamentSize = settings.GetInteger("FloatSelection", "TournamentSize", 2);
+        if (tournamentSize < 1)
+        {
+            std::cout << "Error: FloatSelection tournament size must be at least 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->tournamentSize = tournamentSize;
+    }
+
+    // Get linear rank selection pressure
+    if (settings.HasValue("FloatSelection", "SelectionPressure"))
+    {
+        double selectionPressure = settings.GetReal("FloatSelection", "SelectionPressure", 1.5);
+        if (selectionPressure < 1.0 || selectionPressure > 2.0)
+        {
+            std::cout << "Error: FloatSelection selection pressure must be between 1 and 2. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->selectionPressure = selectionPressure;
+    }
+
+    // Get exponential rank base
+    if (settings.HasValue("FloatSelection", "RankBase"))
+    {
+        double rankBase = settings.GetReal("FloatSelection", "RankBase", 0.9);
+        if (rankBase <= 0.0 || rankBase > 1.0)
+        {
+            std::cout << "Error: FloatSelection rank base must be greater than 0 and at most 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->rankBase = rankBase;
+    }
+
+    // Get number of threads, 0 uses every hardware thread
+    if (settings.HasValue("FloatSelection", "Threads"))
+    {
+        long threads = settings.GetInteger("FloatSelection", "Threads", 1);
+        if (threads < 0)
+        {
+            std::cout << "Error: Invalid FloatSelection thread count. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    }
+
+    // Get population size from which parents are drawn in parallel chunks
+    if (settings.HasValue("FloatSelection", "ParallelThreshold"))
+    {
+        long parallelThreshold = settings.GetInteger("FloatSelection", "ParallelThreshold", 16384);
+        if (parallelThreshold < 1)
+        {
+            std::cout << "Error: FloatSelection parallel threshold must be at least 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->parallelThreshold = parallelThreshold;
+    }
+
+    // Start the worker threads, and rebuild the rank table with the new settings
+    threadPool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+    rankTableSize = 0;
 }
 
 // Implement pure virtual method from base class
 template <class POPULATIONTYPE>
-bool FloatSelection<POPULATIONTYPE>::select(POPULATIONTYPE &population, POPULATIONTYPE &parents)
+bool FloatSelection<POPULATIONTYPE>::select(POPULATIONTYPE &population, Indices &parents)
 {
     return (this->*method)(population, parents);
 };
 
 // Roulette wheel selection
+// Each draw takes O(1) using an alias table built once per generation
+template <class POPULATIONTYPE>
+bool FloatSelection<POPULATIONTYPE>::rouletteWheelSelection(POPULATIONTYPE &population, Indices &parents)
+{
+    // Get the valid candidates and their weights
+    getCandidateWeights(population, parents);
+
+    // Without replacement each candidate can only be chosen once
+    if (!replacementEnabled)
+    {
+        selectWithoutReplacement(parents);
+        return true;
+    }
+
+    // Build the wheel once for the whole generation
+    buildAliasTable();
+
+    // Spin the wheel for each parent
+    drawParents(parents, [this](auto &rng)
+                { return candidates[drawAliasTable(rng)]; });
+
+    return true;
+}
+
+// Stochastic universal sampling
+// All parents are chosen in a single O(N) pass using evenly spaced pointers
 template <class POPULATIONTYPE>
-bool FloatSelection<POPULATIONTYPE>::rouletteWheelSelection(POPULATIONTYPE &population, POPULATIONTYPE &parents)
+bool FloatSelection<POPULATIONTYPE>::stochasticUniversalSampling(POPULATIONTYPE &population, Indices &parents)
 {
-    POPULATIONTYPE candidates;
+    // Get the valid candidates and their weights
+    getCandidateWeights(population, parents);
+
+    if (parents.empty())
+    {
+        return true;
+    }
+
+    // Space the pointers evenly, starting at a random offset
+    double sumOfWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
+    double step = sumOfWeights / parents.size();
+    std::uniform_real_distribution<> offset(0.0, step);
+    double pointer = offset(this->rng);
+
+    // Walk the wheel once, taking each candidate under a pointer
+    double currentSumOfWeights = weights[0];
+    std::size_t candidate = 0;
+    for (unsigned int &parent : parents)
+    {
+        while (currentSumOfWeights <= pointer && candidate + 1 < candidates.size())
+        {
+            ++candidate;
+            currentSumOfWeights += weights[candidate];
+        }
+
+        parent = candidates[candidate];
+        pointer += step;
+    }
+
+    // The pointers choose the parents in population order, so shuffle them before they are paired
+    std::shuffle(parents.begin(), parents.end(), this->rng);
+
+    return true;
+}
 
+// Tournament selection
+// Each parent is the best of tournamentSize candidates drawn uniformly with replacement
+template <class POPULATIONTYPE>
+bool FloatSelection<POPULATIONTYPE>::tournamentSelection(POPULATIONTYPE &population, Indices &parents)
+{
+    // Get the valid candidates
+    getCandidates(population, parents);
+
+    const Individuals &individuals = population.individuals;
+    drawParents(parents, [this, &individuals](auto &rng)
+                {
+                    std::uniform_int_distribution<std::size_t> choice(0, candidates.size() - 1);
+
+                    // Hold the tournament
+                    unsigned int winner = candidates[choice(rng)];
+                    for (unsigned int round = 1; round < tournamentSize; ++round)
+                    {
+                        unsigned int challenger = candidates[choice(rng)];
+                        if (isBetter(individuals[challenger]->score, individuals[winner]->score))
+                        {
+                            winner = challenger;
+                        }
+                    }
+                    return winner; });
+
+    return true;
+}
+
+// Linear rank selection
+// The best candidate is chosen selectionPressure times as often as the average, and the worst 2 - selectionPressure times
+template <class POPULATIONTYPE>
+bool FloatSelection<POPULATIONTYPE>::linearRankSelection(POPULATIONTYPE &population, Indices &parents)
+{
+    return rankSelection(population, parents);
+}
+
+// Exponential rank selection
+// Each candidate is chosen rankBase times as often as the one ranked above it
+template <class POPULATIONTYPE>
+bool FloatSelection<POPULATIONTYPE>::exponentialRankSelection(POPULATIONTYPE &population, Indices &parents)
+{
+    return rankSelection(population, parents);
+}
+
+// Draw parents by rank from a table that only depends on the number of candidates
+template <class POPULATIONTYPE>
+bool FloatSelection<POPULATIONTYPE>::rankSelection(POPULATIONTYPE &population, Indices &parents)
+{
+    // Get the valid candidates, best first
+    getCandidates(population, parents);
+    rankCandidates(population);
+
+    // Build the rank table once for each number of candidates
+    if (rankTableSize != candidates.size())
+    {
+        std::size_t size = candidates.size();
+        weights.resize(size);
+        for (std::size_t rank = 0; rank < size; ++rank)
+        {
+            if (method == &FloatSelection::linearRankSelection)
+            {
+                double position = size > 1 ? static_cast<double>(rank) / (size - 1) : 0.0;
+                weights[rank] = selectionPressure - (2.0 * selectionPressure - 2.0) * position;
+            }
+            else
+            {
+                weights[rank] = std::pow(rankBase, static_cast<double>(rank));
+            }
+        }
+
+        buildAliasTable();
+        rankTableSize = size;
+    }
+
+    // Draw a rank for each parent
+    drawParents(parents, [this](auto &rng)
+                { return candidates[drawAliasTable(rng)]; });
+
+    return true;
+}
+
+// Get the valid candidates
+template <class POPULATIONTYPE>
+void FloatSelection<POPULATIONTYPE>::getCandidates(POPULATIONTYPE &population, const Indices &parents)
+{
     // Get valid candidates
-    for (std::shared_ptr<GenomeType> individual : population.individuals)
+    candidates.clear();
+    for (unsigned int index = 0; index < population.individuals.size(); ++index)
     {
-        if (individual->isPhenotypeValid == true)
+        if (population.individuals[index]->isPhenotypeValid == true)
         {
-            candidates.individuals.push_back(individual);
+            candidates.push_back(index);
         }
     }
 
     // Check that we have enough candidates to proceed
-    if (replacementEnabled)
+    if (replacementEnabled || method != &FloatSelection::rouletteWheelSelection)
     {
-        if (candidates.individuals.size() == 0)
+        if (candidates.size() == 0)
         {
             std::cout << "Error: Zero valid candidates for selection with replacement. Exiting..." << std::endl;
             exit(EXIT_FAILURE);
@@ -135,96 +416,213 @@ bool FloatSelection<POPULATIONTYPE>::rouletteWheelSelection(POPULATIONTYPE &popu
     }
     else
     {
-        if (candidates.individuals.size() < population.individuals.size())
+        if (candidates.size() < parents.size())
         {
             std::cout << "Error: Not enough candidates to fill population without replacement. Exiting..." << std::endl;
             exit(EXIT_FAILURE);
         }
     }
+}
+
+// Get the valid candidates and their weights
+template <class POPULATIONTYPE>
+void FloatSelection<POPULATIONTYPE>::getCandidateWeights(POPULATIONTYPE &population, const Indices &parents)
+{
+    getCandidates(population, parents);
 
     // Get sum of individuals
     double sumOfScores = 0;
-    for (std::shared_ptr<GenomeType> individual : candidates.individuals)
+    for (unsigned int candidate : candidates)
     {
-        sumOfScores += individual->score;
+        sumOfScores += population.individuals[candidate]->score;
     }
 
-    // Get the normalised probabilities of each individual being chosen
-    std::vector<float> candidateProbabilities;
-    for (std::shared_ptr<GenomeType> individual : candidates.individuals)
+    // Get the weight of each individual being chosen
+    weights.clear();
+    for (unsigned int candidate : candidates)
     {
-        float probability = 0.0;
+        const GenomeType &individual = *population.individuals[candidate];
+        double weight = 0.0;
 
+        // Use equal weights if all scores are zero
+        if (sumOfScores == 0.0)
+        {
+            weight = 1.0;
+        }
         // Check the problem type
-        if (isMinimizationProblem)
+        else if (isMinimizationProblem)
         {
             // Subtract normal probability from 1, and divide by number of individuals minus 1 to normalise again
-            probability = (1.0 - (individual->score / sumOfScores)) / (candidates.individuals.size() - 1);
+            weight = candidates.size() > 1 ? (1.0 - (individual.score / sumOfScores)) / (candidates.size() - 1) : 1.0;
         }
         else
         {
             // Normal probability, also used in the formula above
-            probability = individual->score / sumOfScores;
+            weight = individual.score / sumOfScores;
         }
 
-        // Add calculated probability to probabilities vector
-        candidateProbabilities.push_back(probability);
+        // Add calculated weight to weights vector
+        weights.push_back(weight);
     }
+}
 
-    // Scores will be normalised before selection
-    std::uniform_real_distribution<> choice(0.0, 1.0);
+// Sort the candidates from best to worst
+template <class POPULATIONTYPE>
+void FloatSelection<POPULATIONTYPE>::rankCandidates(POPULATIONTYPE &population)
+{
+    const Individuals &individuals = population.individuals;
+
+    // Ties keep population order so the ranking is reproducible
+    std::sort(candidates.begin(), candidates.end(), [this, &individuals](unsigned int a, unsigned int b)
+              {
+                  float scoreA = individuals[a]->score;
+                  float scoreB = individuals[b]->score;
+                  return isBetter(scoreA, scoreB) || (scoreA == scoreB && a < b); });
+}
+
+// Build an alias table from the weights using Vose's method
+template <class POPULATIONTYPE>
+void FloatSelection<POPULATIONTYPE>::buildAliasTable()
+{
+    std::size_t size = weights.size();
+    double sumOfWeights = std::accumulate(weights.begin(), weights.end(), 0.0);
+
+    aliasProbabilities.resize(size);
+    aliasIndices.resize(size);
+    smallColumns.clear();
+    largeColumns.clear();
 
-    // Repeat until we've chosen enough parents
-    while (parents.individuals.size() < population.individuals.size())
+    // Scale the weights so that the average column is 1
+    for (std::size_t column = 0; column < size; ++column)
     {
-        // Select a number in the range of 0 to 1
-        double selection = choice(this->rng);
+        aliasProbabilities[column] = sumOfWeights > 0.0 ? weights[column] * size / sumOfWeights : 1.0;
+        aliasIndices[column] = column;
 
-        // Find the corresponding individual
-        double currentSumOfProbabilities = 0;
-        typename Individuals::iterator individualIt = candidates.individuals.begin();
-        std::vector<float>::iterator probabilityIt = candidateProbabilities.begin();
+        if (aliasProbabilities[column] < 1.0)
+        {
+            smallColumns.push_back(column);
+        }
+        else
+        {
+            largeColumns.push_back(column);
+        }
+    }
+
+    // Fill each small column with the excess of a large column
+    while (!smallColumns.empty() && !largeColumns.empty())
+    {
+        unsigned int small = smallColumns.back();
+        unsigned int large = largeColumns.back();
+        smallColumns.pop_back();
 
-        // Select the individual
-        while (currentSumOfProbabilities <= selection)
+        aliasIndices[small] = large;
+        aliasProbabilities[large] = (aliasProbabilities[large] + aliasProbabilities[small]) - 1.0;
+
+        if (aliasProbabilities[large] < 1.0)
         {
-            // Add the current individual's probabilty to the current sum
-            currentSumOfProbabilities += *probabilityIt;
+            largeColumns.pop_back();
+            smallColumns.push_back(large);
+        }
+    }
 
-            // Check if the sum exceeds the chosen random number
-            // If so, individualIt points to the chosen individual
-            if (currentSumOfProbabilities >= selection)
-            {
-                break;
-            }
-            else
-            {
-                ++individualIt;
-                ++probabilityIt;
-            }
+    // Any columns left over are full, apart from rounding errors
+    for (unsigned int column : smallColumns)
+    {
+        aliasProbabilities[column] = 1.0;
+    }
+    for (unsigned int column : largeColumns)
+    {
+        aliasProbabilities[column] = 1.0;
+    }
+}
+
+// Draw a candidate from the alias table in O(1)
+template <class POPULATIONTYPE>
+template <class ENGINE>
+unsigned int FloatSelection<POPULATIONTYPE>::drawAliasTable(ENGINE &rng) const
+{
+    // A single uniform number chooses both the column and whether to take its alias
+    std::uniform_real_distribution<> choice(0.0, aliasProbabilities.size());
+    double selection = choice(rng);
+    unsigned int column = std::min<std::size_t>(selection, aliasProbabilities.size() - 1);
+
+    return (selection - column) < aliasProbabilities[column] ? column : aliasIndices[column];
+}
+
+// Weighted sampling without replacement (Efraimidis & Spirakis)
+// Each candidate gets the key log(u) / weight and the largest keys are chosen in order.
+// This gives the same distribution as repeatedly spinning the wheel and removing the winner
+template <class POPULATIONTYPE>
+void FloatSelection<POPULATIONTYPE>::selectWithoutReplacement(Indices &parents)
+{
+    std::uniform_real_distribution<> choice(0.0, 1.0);
+
+    // Get the key of each candidate
+    sampleKeys.clear();
+    for (std::size_t candidate = 0; candidate < candidates.size(); ++candidate)
+    {
+        double key = -std::numeric_limits<double>::infinity();
+        if (weights[candidate] > 0.0)
+        {
+            key = std::log(1.0 - choice(this->rng)) / weights[candidate];
         }
+        sampleKeys.emplace_back(key, candidates[candidate]);
+    }
 
-        // Add the selected individual to the parents
-        parents.individuals.push_back(*individualIt);
+    // Take the largest keys, in the order they would have been drawn
+    auto isGreater = [](const std::pair<double, unsigned int> &a, const std::pair<double, unsigned int> &b)
+    { return a.first > b.first; };
+    std::partial_sort(sampleKeys.begin(), sampleKeys.begin() + parents.size(), sampleKeys.end(), isGreater);
+
+    for (std::size_t parent = 0; parent < parents.size(); ++parent)
+    {
+        parents[parent] = sampleKeys[parent].second;
+    }
+}
 
-        // If replacement is disabled, remove the individual from the candidates
-        if (!replacementEnabled)
+// Fill every parent using draw(engine)
+// Large populations are drawn in fixed chunks, each with its own counter-based stream for the chunk,
+// so the chunks' streams never overlap and the parents are the same whether they run on one thread or many
+template <class POPULATIONTYPE>
+template <class DRAW>
+void FloatSelection<POPULATIONTYPE>::drawParents(Indices &parents, DRAW draw)
+{
+    if (parents.size() < parallelThreshold)
+    {
+        for (unsigned int &parent : parents)
         {
-            // Erase the individual
-            candidates.individuals.erase(individualIt);
+            parent = draw(this->rng);
+        }
+        return;
+    }
 
-            // Normalise the other probabilites so we can remove the current individual
-            for (auto probability : candidateProbabilities)
-            {
-                probability = probability / (1.0 - *probabilityIt);
-            }
+    auto drawChunk = [this, &parents, &draw](std::size_t begin, std::size_t end, std::size_t chunk)
+    {
+        CounterRNG chunkRNG = this->getIndividualRNG(chunk);
+        for (std::size_t parent = begin; parent < end; ++parent)
+        {
+            parents[parent] = draw(chunkRNG);
+        }
+    };
 
-            // Erase the current individual's probability
-            candidateProbabilities.erase(probabilityIt);
+    if (threadPool)
+    {
+        threadPool->parallelFor(parents.size(), chunkSize, drawChunk);
+    }
+    else
+    {
+        for (std::size_t chunk = 0; chunk * chunkSize < parents.size(); ++chunk)
+        {
+            drawChunk(chunk * chunkSize, std::min(parents.size(), (chunk + 1) * chunkSize), chunk);
         }
     }
+}
 
-    return true;
+// Compare two scores for the problem type
+template <class POPULATIONTYPE>
+bool FloatSelection<POPULATIONTYPE>::isBetter(const float score, const float other) const
+{
+    return isMinimizationProblem ? score < other : score > other;
 }
 
 #endif
@@ -0,0 +1,418 @@
+#ifndef _LEXICASESELECTION_HPP_
+#define _LEXICASESELECTION_HPP_
+
+// Include system libraries
+#include <random>
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+#include <numeric>
+#include <cstdint>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+// Include abstract classes
+#include "../../abstract/Selection.hpp"
+#include "../../population/LexicasePopulation.hpp"
+
+// This template class provides lexicase selection methods that work
+// with all classes that inherit LexicaseGenome.
+// Each parent is found by filtering the candidates through the cases in a random order,
+// keeping those that are best (or within epsilon of the best) on each case.
+// The candidates are kept in a bitset and the errors in a case-major matrix,
+// so a case is checked for 8 candidates at a time when AVX2 is available.
+template <class POPULATIONTYPE = LexicasePopulation>
+class LexicaseSelection : public Selection<POPULATIONTYPE>
+{
+public:
+    // Define types to help readability
+    using GenomeType = typename POPULATIONTYPE::GenomeType;
+    using GenomePointer = typename POPULATIONTYPE::GenomePointer;
+    using Individuals = typename POPULATIONTYPE::Individuals;
+    using Indices = typename POPULATIONTYPE::Indices;
+
+    LexicaseSelection();           // Default constructor
+    ~LexicaseSelection() override; // Destructor
+
+    // Settings file methods
+    void parseSettings(INIReader &) override;
+
+    bool select(POPULATIONTYPE &population, Indices &parents) override;
+
+protected:
+    // Available selection methods
+    bool lexicaseSelection(POPULATIONTYPE &population, Indices &parents);
+    bool epsilonLexicaseSelection(POPULATIONTYPE &population, Indices &parents);
+
+    // Variable
+    float fixedEpsilon; // Epsilon used for every case, negative to use each case's median absolute deviation
+
+    // Work methods
+    void getCandidates(POPULATIONTYPE &population, const Indices &parents);
+    void buildErrorMatrix(POPULATIONTYPE &population);
+    void getEpsilons(const bool isEpsilonLexicase);
+    void filterParents(Indices &parents);
+    float getPoolMinimum(const float *errors) const;
+    void filterPool(const float *errors, const float threshold);
+    std::size_t compactPool();
+
+    // Buffers kept between generations to avoid reallocating them
+    std::vector<unsigned int> candidates;   // Indices of valid individuals
+    std::size_t caseCount;                  // Number of errors of each individual
+    std::vector<unsigned int> caseOrder;    // Order in which the cases filter a parent
+    std::vector<float> errorMatrix;         // Errors of each candidate, one row per case
+    std::size_t stride;                     // Row length, rounded up to whole pool words
+    std::vector<float> epsilons;            // Epsilon of each row
+    std::vector<float> column;              // Work buffer for the median absolute deviation
+    std::vector<std::uint64_t> fullPool;    // Bitset with every candidate
+    std::vector<std::uint64_t> pool;        // Bitset of the candidates still in the running
+    std::vector<std::size_t> allWords;
+    std::vector<std::size_t> activeWords;   // Words of the pool with candidates left
+
+private:
+    // Method pointer is private so that the prototype can be changed in the derived class
+    typedef bool (LexicaseSelection::*SelectionMethod)(POPULATIONTYPE &population, Indices &parents);
+    SelectionMethod method;
+};
+
+// Default constructor
+template <class POPULATIONTYPE>
+LexicaseSelection<POPULATIONTYPE>::LexicaseSelection()
+    : method(&LexicaseSelection::epsilonLexicaseSelection),
+      fixedEpsilon(-1.0),
+      caseCount(0),
+      stride(0){};
+
+// Destructor
+template <class POPULATIONTYPE>
+LexicaseSelection<POPULATIONTYPE>::~LexicaseSelection(){};
+
+// Settings file parsing
+template <class POPULATIONTYPE>
+void LexicaseSelection<POPULATIONTYPE>::parseSettings(INIReader &settings)
+{
+    // Get selection method
+    if (settings.HasValue("LexicaseSelection", "Method"))
+    {
+        std::string method = settings.Get("LexicaseSelection", "Method", "UNKNOWN");
+
+        if (method == "lexicase")
+        {
+            this->method = &LexicaseSelection::lexicaseSelection;
+        }
+        else if (method == "epsilonLexicase")
+        {
+            this->method = &LexicaseSelection::epsilonLexicaseSelection;
+        }
+        else
+        {
+            std::cout << "Error: Invalid LexicaseSelection method name. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // Get fixed epsilon
+    if (settings.HasValue("LexicaseSelection", "Epsilon"))
+    {
+        double epsilon = settings.GetReal("LexicaseSelection", "Epsilon", -1.0);
+        if (epsilon < 0.0)
+        {
+            std::cout << "Error: LexicaseSelection epsilon can't be negative. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->fixedEpsilon = epsilon;
+    }
+}
+
+// Implement pure virtual method from base class
+template <class POPULATIONTYPE>
+bool LexicaseSelection<POPULATIONTYPE>::select(POPULATIONTYPE &population, Indices &parents)
+{
+    return (this->*method)(population, parents);
+};
+
+// Lexicase selection
+// Only the candidates with the lowest error on a case survive it
+template <class POPULATIONTYPE>
+bool LexicaseSelection<POPULATIONTYPE>::lexicaseSelection(POPULATIONTYPE &population, Indices &parents)
+{
+    getCandidates(population, parents);
+    buildErrorMatrix(population);
+    getEpsilons(false);
+    filterParents(parents);
+
+    return true;
+}
+
+// Epsilon lexicase selection
+// The candidates within epsilon of the lowest error on a case survive it
+template <class POPULATIONTYPE>
+bool LexicaseSelection<POPULATIONTYPE>::epsilonLexicaseSelection(POPULATIONTYPE &population, Indices &parents)
+{
+    getCandidates(population, parents);
+    buildErrorMatrix(population);
+    getEpsilons(true);
+    filterParents(parents);
+
+    return true;
+}
+
+// Get the valid candidates and the number of cases
+template <class POPULATIONTYPE>
+void LexicaseSelection<POPULATIONTYPE>::getCandidates(POPULATIONTYPE &population, const Indices &parents)
+{
+    // Get valid candidates
+    candidates.clear();
+    for (unsigned int index = 0; index < population.individuals.size(); ++index)
+    {
+        if (population.individuals[index]->isPhenotypeValid == true)
+        {
+            candidates.push_back(index);
+        }
+    }
+
+    // Check that we have enough candidates to proceed
+    if (candidates.size() == 0 && parents.size() > 0)
+    {
+        std::cout << "Error: Zero valid candidates for lexicase selection. Exiting..." << std::endl;
+        exit(EXIT_FAILURE);
+    }
+
+    // Check that every candidate has an error for each case
+    caseCount = candidates.empty() ? 0 : population.individuals[candidates[0]]->errors.size();
+    for (unsigned int candidate : candidates)
+    {
+        if (population.individuals[candidate]->errors.size() != caseCount || caseCount == 0)
+        {
+            std::cout << "Error: Lexicase candidates must have an error for every case. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+}
+
+// Copy the errors on the cases into a case-major matrix
+// Padding candidates have an infinite error and are never in the pool
+template <class POPULATIONTYPE>
+void LexicaseSelection<POPULATIONTYPE>::buildErrorMatrix(POPULATIONTYPE &population)
+{
+    std::size_t words = (candidates.size() + 63) / 64;
+    stride = words * 64;
+    errorMatrix.assign(caseCount * stride, std::numeric_limits<float>::infinity());
+
+    for (std::size_t candidate = 0; candidate < candidates.size(); ++candidate)
+    {
+        const std::vector<float> &errors = population.individuals[candidates[candidate]]->errors;
+        for (std::size_t row = 0; row < caseCount; ++row)
+        {
+            // NaN errors never survive a case
+            float error = errors[row];
+            errorMatrix[row * stride + candidate] = std::isnan(error) ? std::numeric_limits<float>::infinity() : error;
+        }
+    }
+
+    // Build the pool with every candidate in it
+    fullPool.assign(words, ~std::uint64_t(0));
+    if (candidates.size() % 64 != 0)
+    {
+        fullPool.back() = (std::uint64_t(1) << (candidates.size() % 64)) - 1;
+    }
+    allWords.resize(words);
+    std::iota(allWords.begin(), allWords.end(), 0);
+}
+
+// Get epsilon for each case
+// Epsilon lexicase uses the median absolute deviation of the errors on the case unless a fixed epsilon is set
+template <class POPULATIONTYPE>
+void LexicaseSelection<POPULATIONTYPE>::getEpsilons(const bool isEpsilonLexicase)
+{
+    epsilons.assign(caseCount, 0.0);
+    if (!isEpsilonLexicase)
+    {
+        return;
+    }
+
+    if (fixedEpsilon >= 0.0)
+    {
+        std::fill(epsilons.begin(), epsilons.end(), fixedEpsilon);
+        return;
+    }
+
+    for (std::size_t row = 0; row < caseCount; ++row)
+    {
+        const float *errors = &errorMatrix[row * stride];
+
+        // Get the median error
+        column.assign(errors, errors + candidates.size());
+        std::nth_element(column.begin(), column.begin() + column.size() / 2, column.end());
+        float median = column[column.size() / 2];
+        if (!std::isfinite(median))
+        {
+            continue;
+        }
+
+        // Get the median of the deviations from it
+        for (float &error : column)
+        {
+            error = std::fabs(error - median);
+        }
+        std::nth_element(column.begin(), column.begin() + column.size() / 2, column.end());
+        float deviation = column[column.size() / 2];
+        epsilons[row] = std::isfinite(deviation) ? deviation : 0.0;
+    }
+}
+
+// Find each parent by filtering the pool through the cases in a random order
+template <class POPULATIONTYPE>
+void LexicaseSelection<POPULATIONTYPE>::filterParents(Indices &parents)
+{
+    // Any order of the cases is a valid starting point for the partial shuffles
+    caseOrder.resize(caseCount);
+    std::iota(caseOrder.begin(), caseOrder.end(), 0);
+
+    for (unsigned int &parent : parents)
+    {
+        pool = fullPool;
+        activeWords = allWords;
+        std::size_t remaining = candidates.size();
+
+        // Only shuffle the cases that are used
+        for (std::size_t index = 0; index < caseOrder.size() && remaining > 1; ++index)
+        {
+            std::uniform_int_distribution<std::size_t> choice(index, caseOrder.size() - 1);
+            std::swap(caseOrder[index], caseOrder[choice(this->rng)]);
+
+            const float *errors = &errorMatrix[caseOrder[index] * stride];
+            filterPool(errors, getPoolMinimum(errors) + epsilons[caseOrder[index]]);
+            remaining = compactPool();
+        }
+
+        // Choose one of the survivors at random
+        std::uniform_int_distribution<std::size_t> choice(0, remaining - 1);
+        std::size_t survivor = choice(this->rng);
+        for (std::size_t word : activeWords)
+        {
+            std::size_t count = __builtin_popcountll(pool[word]);
+            if (survivor < count)
+            {
+                std::uint64_t bits = pool[word];
+                for (; survivor > 0; --survivor)
+                {
+                    bits &= bits - 1;
+                }
+                parent = candidates[word * 64 + __builtin_ctzll(bits)];
+                break;
+            }
+            survivor -= count;
+        }
+    }
+}
+
+// Get the lowest error of the candidates in the pool
+template <class POPULATIONTYPE>
+float LexicaseSelection<POPULATIONTYPE>::getPoolMinimum(const float *errors) const
+{
+    float minimum = std::numeric_limits<float>::infinity();
+
+#ifdef __AVX2__
+    const __m256i laneBits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256 infinity = _mm256_set1_ps(minimum);
+    __m256 minimums = infinity;
+
+    for (std::size_t word : activeWords)
+    {
+        for (unsigned int block = 0; block < 8; ++block)
+        {
+            int byte = (pool[word] >> (block * 8)) & 0xFF;
+            if (byte == 0)
+            {
+                continue;
+            }
+
+            // Spread the 8 pool bits across the lanes and ignore the errors of the other candidates
+            __m256i lanes = _mm256_and_si256(_mm256_set1_epi32(byte), laneBits);
+            __m256 mask = _mm256_castsi256_ps(_mm256_cmpeq_epi32(lanes, laneBits));
+            __m256 values = _mm256_loadu_ps(errors + word * 64 + block * 8);
+            minimums = _mm256_min_ps(minimums, _mm256_blendv_ps(infinity, values, mask));
+        }
+    }
+
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, minimums);
+    minimum = *std::min_element(lanes, lanes + 8);
+#else
+    for (std::size_t word : activeWords)
+    {
+        for (std::uint64_t bits = pool[word]; bits != 0; bits &= bits - 1)
+        {
+            minimum = std::min(minimum, errors[word * 64 + __builtin_ctzll(bits)]);
+        }
+    }
+#endif
+
+    return minimum;
+}
+
+// Remove the candidates with an error above the threshold from the pool
+template <class POPULATIONTYPE>
+void LexicaseSelection<POPULATIONTYPE>::filterPool(const float *errors, const float threshold)
+{
+#ifdef __AVX2__
+    const __m256 limit = _mm256_set1_ps(threshold);
+
+    for (std::size_t word : activeWords)
+    {
+        std::uint64_t kept = 0;
+        for (unsigned int block = 0; block < 8; ++block)
+        {
+            std::uint64_t byte = (pool[word] >> (block * 8)) & 0xFF;
+            if (byte == 0)
+            {
+                continue;
+            }
+
+            __m256 values = _mm256_loadu_ps(errors + word * 64 + block * 8);
+            std::uint64_t passed = _mm256_movemask_ps(_mm256_cmp_ps(values, limit, _CMP_LE_OQ));
+            kept |= (passed & byte) << (block * 8);
+        }
+        pool[word] = kept;
+    }
+#else
+    for (std::size_t word : activeWords)
+    {
+        std::uint64_t kept = pool[word];
+        for (std::uint64_t bits = pool[word]; bits != 0; bits &= bits - 1)
+        {
+            unsigned int bit = __builtin_ctzll(bits);
+            if (errors[word * 64 + bit] > threshold)
+            {
+                kept &= ~(std::uint64_t(1) << bit);
+            }
+        }
+        pool[word] = kept;
+    }
+#endif
+}
+
+// Drop the empty words from the active list and count the candidates left
+template <class POPULATIONTYPE>
+std::size_t LexicaseSelection<POPULATIONTYPE>::compactPool()
+{
+    std::size_t remaining = 0;
+    std::size_t active = 0;
+
+    for (std::size_t word : activeWords)
+    {
+        if (pool[word] != 0)
+        {
+            remaining += __builtin_popcountll(pool[word]);
+            activeWords[active++] = word;
+        }
+    }
+    activeWords.resize(active);
+
+    return remaining;
+}
+
+#endif
@@ -3,6 +3,8 @@
 
 // Include system libraries
 #include <numeric>
+#include <algorithm>
+#include <cstdint>
 
 // Include abstract classes
 #include "../../abstract/Statistics.hpp"
@@ -10,6 +12,7 @@
 
 // This template class provides statistic methods that work
 // with all classes that inherit FloatGenome
+// Scores are only compared at the same fidelity, so only the individuals scored on the most data are used
 template <class POPULATIONTYPE = FloatPopulation>
 class FloatStatistics : public Statistics<POPULATIONTYPE>
 {
@@ -33,8 +36,10 @@ protected:
 
     // Variables
     int currentGeneration;
+    std::uint8_t fidelity; // Fidelity of the individuals used
 
     // Work methods
+    void setFidelity(POPULATIONTYPE &population);
     float getMean(POPULATIONTYPE &population);
     float getMax(POPULATIONTYPE &population);
     float getMin(POPULATIONTYPE &population);
@@ -57,7 +62,8 @@ template <class POPULATIONTYPE>
 FloatStatistics<POPULATIONTYPE>::FloatStatistics()
     : stepFunction(&FloatStatistics::floatStep),
       endFunction(&FloatStatistics::floatEnd),
-      currentGeneration(0){};
+      currentGeneration(0),
+      fidelity(0){};
 
 // Destructor
 template <class POPULATIONTYPE>
@@ -82,6 +88,7 @@ template <class POPULATIONTYPE>
 bool FloatStatistics<POPULATIONTYPE>::floatStep(POPULATIONTYPE &population)
 {
     // TODO: Print out the statistics into a log file
+    setFidelity(population);
     float mean = getMean(population);
     float max = getMax(population);
     float min = getMin(population);
@@ -100,24 +107,41 @@ bool FloatStatistics<POPULATIONTYPE>::floatStep(POPULATIONTYPE &population)
 template <class POPULATIONTYPE>
 bool FloatStatistics<POPULATIONTYPE>::floatEnd(POPULATIONTYPE &population)
 {
+    setFidelity(population);
     printBestIndividual(population);
 
     return true;
 }
 
+// Use the individuals scored at the best fidelity in the population
+template <class POPULATIONTYPE>
+void FloatStatistics<POPULATIONTYPE>::setFidelity(POPULATIONTYPE &population)
+{
+    fidelity = UINT8_MAX;
+    for (std::shared_ptr<FloatGenome> &individual : population.individuals)
+    {
+        fidelity = std::min(fidelity, individual->fidelity);
+    }
+}
+
 template <class POPULATIONTYPE>
 float FloatStatistics<POPULATIONTYPE>::getMean(POPULATIONTYPE &population)
 {
     float mean = 0;
+    std::size_t count = 0;
 
     // Add up the scores of the population
     for (std::shared_ptr<FloatGenome> &individual : population.individuals)
     {
-        mean += individual->score;
+        if (individual->fidelity == fidelity)
+        {
+            mean += individual->score;
+            ++count;
+        }
     }
 
-    // Divide by the population size
-    mean = mean / population.individuals.size();
+    // Divide by the number of individuals used
+    mean = mean / count;
 
     return mean;
 }
@@ -131,6 +155,10 @@ float FloatStatistics<POPULATIONTYPE>::getMax(POPULATIONTYPE &population)
     auto it = population.individuals.begin();
 
     // Set first element to compare the rest against
+    while (it != population.individuals.end() && it->get()->fidelity != fidelity)
+    {
+        ++it;
+    }
     if (it != population.individuals.end())
     {
         max = it->get()->score;
@@ -140,7 +168,7 @@ float FloatStatistics<POPULATIONTYPE>::getMax(POPULATIONTYPE &population)
     // Check the rest of the elements
     while (it != population.individuals.end())
     {
-        if (max < it->get()->score)
+        if (it->get()->fidelity == fidelity && max < it->get()->score)
         {
             max = it->get()->score;
         }
@@ -160,6 +188,10 @@ float FloatStatistics<POPULATIONTYPE>::getMin(POPULATIONTYPE &population)
     auto it = population.individuals.begin();
 
     // Set first element to compare the rest against
+    while (it != population.individuals.end() && it->get()->fidelity != fidelity)
+    {
+        ++it;
+    }
     if (it != population.individuals.end())
     {
         min = it->get()->score;
@@ -169,7 +201,7 @@ float FloatStatistics<POPULATIONTYPE>::getMin(POPULATIONTYPE &population)
     // Check the rest of the elements
     while (it != population.individuals.end())
     {
-        if (min > it->get()->score)
+        if (it->get()->fidelity == fidelity && min > it->get()->score)
         {
             min = it->get()->score;
         }
@@ -184,25 +216,33 @@ template <class POPULATIONTYPE>
 float FloatStatistics<POPULATIONTYPE>::getStandardDeviation(POPULATIONTYPE &population)
 {
     float sum = 0;
+    std::size_t count = 0;
 
     // Add up the scores of the population
     for (std::shared_ptr<FloatGenome> &individual : population.individuals)
     {
-        sum += individual->score;
+        if (individual->fidelity == fidelity)
+        {
+            sum += individual->score;
+            ++count;
+        }
     }
 
     // Get X Hat (average value)
-    float xhat = sum / population.individuals.size();
+    float xhat = sum / count;
 
     // Get summation of sum((X-XHat)^2)
     float summation = 0;
     for (std::shared_ptr<FloatGenome> &individual : population.individuals)
     {
-        summation += pow((individual->score - xhat), 2);
+        if (individual->fidelity == fidelity)
+        {
+            summation += pow((individual->score - xhat), 2);
+        }
     }
 
     // Get standard deviation by dividing by n-1
-    float sd = sqrt(summation / (population.individuals.size() - 1));
+    float sd = sqrt(summation / (count - 1));
 
     // Return the standard deviation
     return sd;
@@ -218,6 +258,11 @@ void FloatStatistics<POPULATIONTYPE>::printBestIndividual(POPULATIONTYPE &popula
     auto best = it;
 
     // Set first element to compare the rest against
+    while (it != population.individuals.end() && it->get()->fidelity != fidelity)
+    {
+        ++it;
+    }
+    best = it;
     if (it != population.individuals.end())
     {
         max = it->get()->score;
@@ -227,7 +272,7 @@ void FloatStatistics<POPULATIONTYPE>::printBestIndividual(POPULATIONTYPE &popula
     // Check the rest of the elements
     while (it != population.individuals.end())
     {
-        if (max < it->get()->score)
+        if (it->get()->fidelity == fidelity && max < it->get()->score)
         {
             max = it->get()->score;
             best = it;
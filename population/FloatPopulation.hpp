@@ -18,8 +18,11 @@ public:
     using GenomeType = Population<FloatGenome>::GenomeType;
     using GenomePointer = Population<FloatGenome>::GenomePointer;
     using Individuals = Population<FloatGenome>::Individuals;
+    using Indices = Population<FloatGenome>::Indices;
+    using Pool = Population<FloatGenome>::Pool;
 
-    FloatPopulation(){}; // Default constructor
+    FloatPopulation(std::pmr::memory_resource *resource = std::pmr::get_default_resource(), Pool *pool = nullptr) // Default constructor
+        : Population<FloatGenome>(resource, pool){};
     virtual ~FloatPopulation(){}; // Destructor
 };
 
@@ -0,0 +1,29 @@
+#ifndef _LEXICASEPOPULATION_HPP_
+#define _LEXICASEPOPULATION_HPP_
+
+// Include system libraries
+#include <vector>
+#include <memory>
+#include <type_traits>
+
+#include "../genome/LexicaseGenome.hpp"
+
+// Include abstract classes
+#include "../abstract/Population.hpp"
+
+class LexicasePopulation : public Population<LexicaseGenome>
+{
+public:
+    // Declare types to simplify expressions
+    using GenomeType = Population<LexicaseGenome>::GenomeType;
+    using GenomePointer = Population<LexicaseGenome>::GenomePointer;
+    using Individuals = Population<LexicaseGenome>::Individuals;
+    using Indices = Population<LexicaseGenome>::Indices;
+    using Pool = Population<LexicaseGenome>::Pool;
+
+    LexicasePopulation(std::pmr::memory_resource *resource = std::pmr::get_default_resource(), Pool *pool = nullptr) // Default constructor
+        : Population<LexicaseGenome>(resource, pool){};
+    virtual ~LexicasePopulation(){}; // Destructor
+};
+
+#endif
@@ -0,0 +1,79 @@
+// Checks that a generation allocates next to nothing once the arena, the genome pool and
+// the mapper's derivation trees have warmed up, by counting every call to operator new
+
+// Include system libraries
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+
+// Include grace
+#include "grace.hpp"
+
+// Allocations made so far
+static std::atomic<unsigned long> allocations(0);
+
+void *operator new(std::size_t size)
+{
+    ++allocations;
+    if (void *pointer = std::malloc(size ? size : 1))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept
+{
+    std::free(pointer);
+}
+
+// Scores phenotypes by how close they are to 20 characters long, without allocating
+class LengthEvaluator : public Evaluator<FloatPopulation>
+{
+public:
+    bool evaluate(FloatPopulation &population) override
+    {
+        for (const FloatPopulation::GenomePointer &individual : population.individuals)
+        {
+            individual->score = individual->isPhenotypeValid ? 1.0f / (1.0f + std::abs(20.0f - individual->phenotype.size())) : 0.0f;
+            individual->isEvaluated = true;
+        }
+        return true;
+    }
+};
+
+int main(int argc, char **argv)
+{
+    const int warmUpGenerations = 100;
+    const int measuredGenerations = 20;
+
+    GeneticAlgorithm<FloatPopulation, GEInitialiser<FloatPopulation>, GEMapper<FloatPopulation>, LengthEvaluator,
+                     FloatSelection<FloatPopulation>, GECrossover<FloatPopulation>, GEMutation<FloatPopulation>,
+                     FloatReplacement<FloatPopulation>, GETermination<FloatPopulation>, FloatStatistics<FloatPopulation>>
+        ga(1, argv, "allocation.ini");
+
+    ga.initialise();
+    for (int generation = 0; generation < warmUpGenerations; ++generation)
+    {
+        ga.step();
+    }
+
+    unsigned long before = allocations;
+    for (int generation = 0; generation < measuredGenerations; ++generation)
+    {
+        ga.step();
+    }
+    unsigned long perGeneration = (allocations - before) / measuredGenerations;
+
+    // Allow one allocation for every 10 individuals, for trees that grow past any seen before
+    unsigned long limit = ga.population.individuals.size() / 10;
+    std::cout << "Allocations per generation: " << perGeneration << " (limit " << limit << ")" << std::endl;
+    return perGeneration <= limit ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,173 @@
+// Checks that TruthTable counts the hits of a circuit the same way as working it out one row at a time:
+// over inputs past the twelfth, which are worked out from the word index, over blocks after the first,
+// and over tables of fewer than 64 rows, where the last word is trimmed. Known circuits must get every
+// row right. Also checks that BooleanCompiler folds gates of constants and merges repeated gates
+
+// Include system libraries
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Include grace
+#include "grace.hpp"
+
+// Get the names x0, x1, ... of the inputs
+static std::vector<std::string> getNames(const unsigned int inputCount)
+{
+    std::vector<std::string> names;
+    for (unsigned int input = 0; input < inputCount; ++input)
+    {
+        names.push_back("x" + std::to_string(input));
+    }
+    return names;
+}
+
+// Count the output bits the circuit gets right, working out every gate one row at a time
+static std::uint64_t countReferenceHits(const BooleanCircuit::Circuit &circuit, const unsigned int outputCount, const std::function<std::uint64_t(std::uint64_t)> &target)
+{
+    std::uint64_t hits = 0;
+    std::vector<bool> values(circuit.getSignalCount());
+    for (std::uint64_t row = 0; row < (std::uint64_t(1) << circuit.inputCount); ++row)
+    {
+        values[0] = false;
+        values[1] = true;
+        for (unsigned int input = 0; input < circuit.inputCount; ++input)
+        {
+            values[2 + input] = (row >> input) & 1;
+        }
+
+        std::uint32_t signal = 2 + circuit.inputCount;
+        for (const BooleanCircuit::Gate &gate : circuit.gates)
+        {
+            bool a = values[gate.a];
+            bool b = values[gate.b];
+            bool c = values[gate.c];
+            switch (gate.type)
+            {
+            case BooleanCircuit::And:
+                values[signal++] = a && b;
+                break;
+            case BooleanCircuit::Or:
+                values[signal++] = a || b;
+                break;
+            case BooleanCircuit::Xor:
+                values[signal++] = a != b;
+                break;
+            case BooleanCircuit::Nand:
+                values[signal++] = !(a && b);
+                break;
+            case BooleanCircuit::Nor:
+                values[signal++] = !(a || b);
+                break;
+            case BooleanCircuit::Xnor:
+                values[signal++] = a == b;
+                break;
+            case BooleanCircuit::Not:
+                values[signal++] = !a;
+                break;
+            default:
+                values[signal++] = a ? b : c;
+                break;
+            }
+        }
+
+        std::uint64_t outputs = target(row);
+        for (unsigned int output = 0; output < outputCount; ++output)
+        {
+            hits += values[circuit.outputs[output]] == static_cast<bool>((outputs >> output) & 1);
+        }
+    }
+    return hits;
+}
+
+// Compile the phenotype and check its hits against the reference, and against a perfect score if it is a known solution
+static bool checkHits(const std::string &name, const std::vector<std::string> &inputs, const unsigned int outputCount,
+                      const std::function<std::uint64_t(std::uint64_t)> &target, const std::string &phenotype, const bool isSolution)
+{
+    BooleanCompiler compiler;
+    compiler.setInputs(inputs);
+
+    BooleanCircuit::Circuit circuit;
+    bool isPassed = compiler.compile(phenotype, circuit);
+
+    TruthTable table;
+    table.setTargets(inputs.size(), outputCount, target);
+    std::uint64_t hits = table.countHits(circuit);
+    std::uint64_t expected = circuit.outputs.size() == outputCount ? countReferenceHits(circuit, outputCount, target) : 0;
+    isPassed = isPassed && hits == expected && (hits == table.getMaxHits()) == isSolution;
+
+    std::cout << name << ": " << (isPassed ? "passed" : "failed") << " (" << hits << " hits, expected " << expected
+              << " of " << table.getMaxHits() << ")" << std::endl;
+    return isPassed;
+}
+
+// Compile the phenotype and check how many gates it has and which signals the outputs are
+static bool checkGates(const std::string &name, const std::string &phenotype, const std::size_t gateCount, const std::vector<std::uint32_t> &outputs)
+{
+    BooleanCompiler compiler;
+    compiler.setInputs(getNames(3));
+
+    BooleanCircuit::Circuit circuit;
+    bool isPassed = compiler.compile(phenotype, circuit) && circuit.gates.size() == gateCount && circuit.outputs == outputs;
+
+    std::cout << name << ": " << (isPassed ? "passed" : "failed") << " (" << phenotype << ", " << circuit.gates.size() << " gates)" << std::endl;
+    return isPassed;
+}
+
+int main()
+{
+    bool isPassed = true;
+
+    // Even parity of 13 inputs, so input 12 is worked out from the word index and the table is two blocks of 64 words
+    std::function<std::uint64_t(std::uint64_t)> parity = [](std::uint64_t row)
+    { return __builtin_popcountll(row) & 1; };
+    std::string parityCircuit = "x0";
+    for (unsigned int input = 1; input < 13; ++input)
+    {
+        parityCircuit += " ^ x" + std::to_string(input);
+    }
+    isPassed &= checkHits("Parity", getNames(13), 1, parity, parityCircuit, true);
+
+    // Leaving out the last input gets exactly half of the rows right
+    isPassed &= checkHits("Parity without x12", getNames(13), 1, parity, parityCircuit.substr(0, parityCircuit.rfind(" ^")), false);
+
+    // A circuit that depends on every input of a table of 15 inputs and 8 blocks
+    isPassed &= checkHits("Derived inputs", getNames(15), 2, [](std::uint64_t row)
+                          { return (((row >> 14) ^ (row >> 3) ^ ((row >> 12) & (row >> 7))) & 1) | (((row >> 13) & row & 1) << 1); },
+                          "x14 ^ x3 ^ x12 & x7 ^ x1 & !x13; if(x13, x0, x12 | x11 & nor(x9, x10) | xnor(x2, x5) & x6 & x8 & x4)", false);
+
+    // The 6-multiplexer, where the two address inputs choose one of the four data inputs
+    isPassed &= checkHits("6-multiplexer", {"a0", "a1", "d0", "d1", "d2", "d3"}, 1, [](std::uint64_t row)
+                          { return (row >> (2 + (row & 3))) & 1; },
+                          "if(a1, if(a0, d3, d2), if(a0, d1, d0))", true);
+    isPassed &= checkHits("6-multiplexer with a wrong branch", {"a0", "a1", "d0", "d1", "d2", "d3"}, 1, [](std::uint64_t row)
+                          { return (row >> (2 + (row & 3))) & 1; },
+                          "if(a1, if(a0, d3, d2), if(a0, d0, d1))", false);
+
+    // A 2-bit adder, whose 16 rows leave most of the only word past the end of the table
+    std::function<std::uint64_t(std::uint64_t)> adder = [](std::uint64_t row)
+    { return (row & 3) + (row >> 2 & 3); };
+    std::vector<std::string> adderInputs = {"a0", "a1", "b0", "b1"};
+    isPassed &= checkHits("2-bit adder", adderInputs, 3, adder,
+                          "a0 ^ b0; a1 ^ b1 ^ a0 & b0; a1 & b1 | a0 & b0 & (a1 ^ b1)", true);
+
+    // Outputs that are always 0 or always 1 only get the rows of the table right, not the rest of the word
+    isPassed &= checkHits("2-bit adder with constant outputs", adderInputs, 3, adder, "0; 1; 0", false);
+
+    // A circuit with the wrong number of outputs gets nothing right
+    isPassed &= checkHits("Wrong outputs", adderInputs, 3, adder, "a0 ^ b0; a1 ^ b1", false);
+
+    // Gates of constants are worked out while compiling
+    isPassed &= checkGates("Folding", "!(1 & 0) ^ 0; nand(1, 1) | if(1, 0, 1); xnor(0, 0) & not 0", 0, {1, 0, 1});
+    isPassed &= checkGates("Folding around inputs", "x0 & (1 ^ 1)", 1, {5});
+
+    // Gates that repeat an earlier one, including with their inputs swapped, are merged
+    isPassed &= checkGates("Merging", "x0 & x1 | x1 & x0", 2, {6});
+    isPassed &= checkGates("Merging across outputs", "x0 ^ x1; x1 xor x0; !x2 & not x2", 3, {5, 5, 7});
+    isPassed &= checkGates("Keeping multiplexer order", "if(x0, x1, x2) | if(x0, x2, x1)", 3, {7});
+
+    return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
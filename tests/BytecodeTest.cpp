@@ -0,0 +1,193 @@
+// Checks that BytecodeCompiler parses expressions with the right precedence and associativity,
+// folds constants and rejects operators that weren't declared, and that BytecodeInterpreter
+// gives the same values and errors as plain scalar code over a row count that isn't a whole
+// number of blocks or lanes
+
+// Include system libraries
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Include grace
+#include "grace.hpp"
+
+// Rows of the test data, which leaves part of a block and part of the error lanes over
+static const std::size_t rowCount = 1000;
+
+// Test data, with y kept away from zero so it can be divided by
+static std::vector<float> xs;
+static std::vector<float> ys;
+static std::vector<float> target;
+
+// Compile the expression and check that every row gives exactly the reference value
+static bool checkValues(const std::string &name, const std::string &expression, const std::function<float(float, float)> &reference)
+{
+    BytecodeCompiler compiler;
+    compiler.setVariables({"x", "y"});
+
+    Bytecode::Program program;
+    bool isPassed = compiler.compile(expression, program);
+
+    std::size_t rows = 0;
+    if (isPassed)
+    {
+        const float *columns[] = {xs.data(), ys.data()};
+        BytecodeInterpreter interpreter;
+        interpreter.run(program, columns, rowCount, [&](const float *values, std::size_t begin, std::size_t count)
+                        {
+                            for (std::size_t row = 0; row < count; ++row)
+                            {
+                                isPassed = isPassed && values[row] == reference(xs[begin + row], ys[begin + row]);
+                            }
+                            rows += count;
+                            return true; });
+    }
+    isPassed = isPassed && rows == rowCount;
+
+    std::cout << name << ": " << (isPassed ? "passed" : "failed") << " (" << expression << ")" << std::endl;
+    return isPassed;
+}
+
+// Compile the expression and check that it was folded down to the given code
+static bool checkFolded(const std::string &name, const std::string &expression, const std::vector<Bytecode::Opcode> &code, const std::vector<float> &constants)
+{
+    BytecodeCompiler compiler;
+    compiler.setVariables({"x", "y"});
+
+    Bytecode::Program program;
+    bool isPassed = compiler.compile(expression, program) && program.code.size() == code.size() && program.constants == constants;
+    for (std::size_t index = 0; isPassed && index < code.size(); ++index)
+    {
+        isPassed = program.code[index].opcode == code[index];
+    }
+
+    std::cout << name << ": " << (isPassed ? "passed" : "failed") << " (" << expression << ", " << program.code.size() << " instructions)" << std::endl;
+    return isPassed;
+}
+
+// Check whether the expression compiles with only the given operators declared
+static bool checkDeclared(const std::vector<std::string> &operators, const std::string &expression, const bool isValid)
+{
+    BytecodeCompiler compiler;
+    compiler.setVariables({"x", "y"});
+    compiler.setOperators(operators);
+
+    Bytecode::Program program;
+    bool isPassed = compiler.compile(expression, program) == isValid;
+
+    std::cout << "Declared operators: " << (isPassed ? "passed" : "failed") << " (" << expression << (isValid ? " compiles" : " is rejected") << ")" << std::endl;
+    return isPassed;
+}
+
+// Check the interpreter's error against the same error worked out one row at a time.
+// The reference is summed in one go, so it only matches if the blocks are summed in the same order
+static bool checkError(const std::string &name, const std::string &expression, const std::function<float(float, float)> &reference, const bool isSquared)
+{
+    BytecodeCompiler compiler;
+    compiler.setVariables({"x", "y"});
+
+    Bytecode::Program program;
+    bool isPassed = compiler.compile(expression, program);
+
+    const float *columns[] = {xs.data(), ys.data()};
+    BytecodeInterpreter interpreter;
+    IncrementalError sum;
+    sum.reset(rowCount);
+    isPassed = isPassed && (isSquared ? interpreter.sumSquaredError(program, columns, target.data(), rowCount, sum)
+                                      : interpreter.sumAbsoluteError(program, columns, target.data(), rowCount, sum));
+
+    std::vector<float> values(rowCount);
+    for (std::size_t row = 0; row < rowCount; ++row)
+    {
+        values[row] = reference(xs[row], ys[row]);
+    }
+    IncrementalError expected;
+    expected.reset(rowCount);
+    if (isSquared)
+    {
+        expected.add(values.data(), target.data(), rowCount, [](float difference)
+                     { return difference * difference; });
+    }
+    else
+    {
+        expected.add(values.data(), target.data(), rowCount, [](float difference)
+                     { return std::fabs(difference); });
+    }
+    isPassed = isPassed && sum.getRows() == rowCount && sum.getSum() == expected.getSum();
+
+    std::cout << name << ": " << (isPassed ? "passed" : "failed") << " (" << sum.getSum() << ", expected " << expected.getSum() << ")" << std::endl;
+    return isPassed;
+}
+
+int main()
+{
+    for (std::size_t row = 0; row < rowCount; ++row)
+    {
+        xs.push_back((row % 37) * 0.1f - 1.7f);
+        ys.push_back(1.0f + (row % 11) * 0.25f);
+        target.push_back(std::sin(row * 0.01f));
+    }
+
+    bool isPassed = true;
+
+    // Multiplication and division bind tighter than addition and subtraction, which go left to right
+    isPassed &= checkValues("Precedence", "x + y * x - y / 2", [](float x, float y)
+                            { return (x + y * x) - y / 2.0f; });
+    isPassed &= checkValues("Left associativity", "x - y - x / y / 2", [](float x, float y)
+                            { return (x - y) - (x / y) / 2.0f; });
+    isPassed &= checkValues("Brackets", "(x + y) * (x - y)", [](float x, float y)
+                            { return (x + y) * (x - y); });
+
+    // Unary minus binds looser than ^ but tighter than *
+    isPassed &= checkValues("Unary minus", "-x ^ 2 + x * -y - -x", [](float x, float y)
+                            { return (-std::pow(x, 2.0f) + x * -y) - -x; });
+    isPassed &= checkValues("Power of a negation", "y ^ -x", [](float x, float y)
+                            { return std::pow(y, -x); });
+
+    // ^ goes right to left
+    isPassed &= checkValues("Right associativity", "y ^ x ^ 2", [](float x, float y)
+                            { return std::pow(y, std::pow(x, 2.0f)); });
+
+    // Functions take whole expressions as arguments
+    isPassed &= checkValues("Functions", "max(x, y - 2) * sin(x * y) + abs(min(x, -y))", [](float x, float y)
+                            { return std::max(x, y - 2.0f) * std::sin(x * y) + std::fabs(std::min(x, -y)); });
+
+    // Operators on constants are worked out while compiling
+    isPassed &= checkFolded("Folding", "1 + 2 * 3", {Bytecode::PushConstant}, {7.0f});
+    isPassed &= checkFolded("Folding right associativity", "2 ^ 3 ^ 2", {Bytecode::PushConstant}, {512.0f});
+    isPassed &= checkFolded("Folding unary minus", "-2 ^ 2", {Bytecode::PushConstant}, {-4.0f});
+    isPassed &= checkFolded("Folding around variables", "x * (2 + 3) ^ 2 - sqrt(16)",
+                            {Bytecode::PushVariable, Bytecode::PushConstant, Bytecode::Multiply, Bytecode::PushConstant, Bytecode::Subtract}, {25.0f, 4.0f});
+    isPassed &= checkFolded("No folding past variables", "x + 1 + 2",
+                            {Bytecode::PushVariable, Bytecode::PushConstant, Bytecode::Add, Bytecode::PushConstant, Bytecode::Add}, {1.0f, 2.0f});
+
+    // Only declared operators can be used, even on constants, and subtraction also declares unary minus
+    isPassed &= checkDeclared({"+", "*"}, "x + y * x", true);
+    isPassed &= checkDeclared({"+", "*"}, "x - y", false);
+    isPassed &= checkDeclared({"+", "*"}, "-x", false);
+    isPassed &= checkDeclared({"+", "*"}, "x / y", false);
+    isPassed &= checkDeclared({"+", "*"}, "x ^ 2", false);
+    isPassed &= checkDeclared({"+", "*"}, "2 - 1", false);
+    isPassed &= checkDeclared({"+", "*"}, "sin(x)", false);
+    isPassed &= checkDeclared({"-"}, "-x - y", true);
+    isPassed &= checkDeclared({"pow"}, "x ^ y", true);
+
+    // Expressions that aren't valid are rejected whatever is declared
+    isPassed &= checkDeclared(BytecodeCompiler::getOperatorNames(), "x +", false);
+    isPassed &= checkDeclared(BytecodeCompiler::getOperatorNames(), "(x + y", false);
+    isPassed &= checkDeclared(BytecodeCompiler::getOperatorNames(), "x y", false);
+    isPassed &= checkDeclared(BytecodeCompiler::getOperatorNames(), "z + 1", false);
+    isPassed &= checkDeclared(BytecodeCompiler::getOperatorNames(), "max(x)", false);
+
+    // The errors are summed exactly as a row at a time
+    isPassed &= checkError("Squared error", "x * y - x / (y + 2) + tanh(x) ^ 2", [](float x, float y)
+                           { return (x * y - x / (y + 2.0f)) + std::pow(std::tanh(x), 2.0f); }, true);
+    isPassed &= checkError("Absolute error", "exp(-x * x) * cos(y) - log(y)", [](float x, float y)
+                           { return std::exp(-x * x) * std::cos(y) - std::log(y); }, false);
+
+    return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,136 @@
+// Checks that BytecodeEvaluator gives exactly the same scores whether phenotypes are compiled to
+// native code or interpreted, both over every row and when a cutoff stops scoring early.
+// Skipped when there is no cc to compile phenotypes with
+
+// Include system libraries
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Include grace
+#include "grace.hpp"
+
+// Exit code that tells ctest the test was skipped
+static const int skipCode = 77;
+
+// Phenotypes to score. One doesn't compile and one has no finite error
+static const std::vector<std::string> phenotypes = {
+    "x * y - z",
+    "x * x * 0.5 + y / (z + 3) - 1",
+    "(x - y) * (x + 1.5) / (z * z + 1) + min(x, y) * max(y, z)",
+    "-x ^ 2 + y ^ 3 - x * y * z",
+    "sin(x * y) + cos(z) * exp(-x * x) - sqrt(abs(y)) * tanh(z)",
+    "log(abs(x) + 1) * 3 - 2 * y + 4 * z",
+    "x * 100 + y * 100",
+    "x + * y",
+    "log(x)"};
+
+// Write the dataset and the settings of both evaluators to the temporary folder
+static std::string writeFiles(const std::string &directory)
+{
+    // 1000 rows, so the last block and the last lanes are only partly full
+    std::ofstream data(directory + "/grace_native_test.csv");
+    data << "x,y,z,target" << std::endl;
+    for (int row = 0; row < 1000; ++row)
+    {
+        float x = (row % 37) * 0.1f - 1.7f;
+        float y = (row % 11) * 0.3f - 1.4f;
+        float z = (row % 23) * 0.07f;
+        data << x << "," << y << "," << z << "," << x * y - z + std::sin(row * 0.01f) << std::endl;
+    }
+
+    for (const std::string native : {"true", "false"})
+    {
+        std::ofstream settings(directory + "/grace_native_test_" + native + ".ini");
+        settings << "[BytecodeEvaluator]" << std::endl
+                 << "DataFile = " << directory << "/grace_native_test.csv" << std::endl
+                 << "Native = " << native << std::endl
+                 << "NativeDirectory = " << directory << std::endl
+                 << "InvalidScore = -1" << std::endl;
+    }
+    return directory + "/grace_native_test_";
+}
+
+// Score the phenotypes with both evaluators and compare the scores and rejections
+static bool check(BytecodeEvaluator<FloatPopulation> &native, BytecodeEvaluator<FloatPopulation> &interpreted, const std::string &name,
+                  const std::size_t expectedRejections)
+{
+    FloatPopulation nativePopulation;
+    FloatPopulation interpretedPopulation;
+    for (FloatPopulation *population : {&nativePopulation, &interpretedPopulation})
+    {
+        for (std::size_t index = 0; index < phenotypes.size(); ++index)
+        {
+            FloatPopulation::GenomePointer individual = population->createGenome();
+            individual->phenotype = phenotypes[index];
+            individual->phenotypeHash = index;
+            individual->isPhenotypeValid = true;
+            population->individuals.push_back(individual);
+        }
+    }
+
+    native.evaluate(nativePopulation);
+    interpreted.evaluate(interpretedPopulation);
+
+    bool isPassed = native.isNativeAvailable();
+    std::size_t rejections = 0;
+    for (std::size_t index = 0; index < phenotypes.size(); ++index)
+    {
+        const FloatGenome &a = *nativePopulation.individuals[index];
+        const FloatGenome &b = *interpretedPopulation.individuals[index];
+        isPassed = isPassed && a.isEvaluated && b.isEvaluated && a.score == b.score && a.isRejected == b.isRejected;
+        rejections += b.isRejected;
+        if (a.score != b.score || a.isRejected != b.isRejected)
+        {
+            std::cout << "  " << phenotypes[index] << ": native " << a.score << (a.isRejected ? " rejected" : "")
+                      << ", interpreted " << b.score << (b.isRejected ? " rejected" : "") << std::endl;
+        }
+    }
+    isPassed = isPassed && rejections == expectedRejections;
+
+    std::cout << name << ": " << (isPassed ? "passed" : "failed") << " (" << rejections << " rejected)" << std::endl;
+    return isPassed;
+}
+
+int main()
+{
+    if (std::system("cc --version > /dev/null 2>&1") != 0)
+    {
+        std::cout << "Skipped: cc isn't available" << std::endl;
+        return skipCode;
+    }
+
+    const char *directory = std::getenv("TMPDIR");
+    std::string settingsPath = writeFiles(directory ? directory : "/tmp");
+
+    INIReader nativeSettings(settingsPath + "true.ini");
+    INIReader interpretedSettings(settingsPath + "false.ini");
+    if (nativeSettings.ParseError() != 0 || interpretedSettings.ParseError() != 0)
+    {
+        std::cout << "Error: Unable to write the test settings" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    BytecodeEvaluator<FloatPopulation> native;
+    BytecodeEvaluator<FloatPopulation> interpreted;
+    native.parseSettings(nativeSettings);
+    interpreted.parseSettings(interpretedSettings);
+
+    bool isPassed = true;
+
+    // Every row is scored
+    isPassed &= check(native, interpreted, "Every row", 0);
+
+    // The same functions again, from the native cache
+    isPassed &= check(native, interpreted, "Cached", 0);
+
+    // Scoring stops at a check between blocks once the error is past the cutoff, and the bound so far is the score
+    native.setCutoff(4.0f);
+    interpreted.setCutoff(4.0f);
+    isPassed &= check(native, interpreted, "Cutoff", 4);
+
+    return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
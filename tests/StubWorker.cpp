@@ -0,0 +1,45 @@
+// A worker for SubprocessTest, whose phenotypes say what it should do with them:
+//   a number - reply with the number as its score
+//   sleep    - sleep past any timeout without replying
+//   crash    - end without replying, in the middle of the batch
+//   garbage  - reply with something that isn't a number
+//   quit     - reply with 0, then end while idle
+
+// Include system libraries
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <chrono>
+
+int main()
+{
+    std::string line;
+    while (std::getline(std::cin, line))
+    {
+        if (line == "sleep")
+        {
+            std::this_thread::sleep_for(std::chrono::seconds(60));
+        }
+        else if (line == "crash")
+        {
+            return EXIT_FAILURE;
+        }
+        else if (line == "garbage")
+        {
+            std::cout << "garbage" << std::endl;
+        }
+        else if (line == "quit")
+        {
+            // Wait a moment, so the reply is read before the worker is seen to end
+            std::cout << 0 << std::endl;
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            return EXIT_SUCCESS;
+        }
+        else
+        {
+            std::cout << line << std::endl;
+        }
+    }
+    return EXIT_SUCCESS;
+}
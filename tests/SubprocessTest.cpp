@@ -0,0 +1,77 @@
+// Checks how SubprocessEvaluator deals with workers that fail, using StubWorker as the worker:
+// which phenotypes get the penalty score, how many times the worker is restarted,
+// and that the phenotypes a failed worker hadn't scored are sent again
+
+// Include system libraries
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Include grace
+#include "grace.hpp"
+
+// Score one population with the evaluator and compare the scores and failure counts with the expected ones
+static bool check(SubprocessEvaluator<FloatPopulation> &evaluator, const std::string &name,
+                  const std::vector<std::string> &phenotypes, const std::vector<float> &scores,
+                  const unsigned long long failures, const unsigned long long restarts)
+{
+    FloatPopulation population;
+    for (const std::string &phenotype : phenotypes)
+    {
+        FloatPopulation::GenomePointer individual = population.createGenome();
+        individual->phenotype = phenotype;
+        individual->isPhenotypeValid = !phenotype.empty();
+        population.individuals.push_back(individual);
+    }
+
+    evaluator.evaluate(population);
+
+    bool isPassed = evaluator.getFailures() == failures && evaluator.getRestarts() == restarts;
+    for (std::size_t index = 0; index < phenotypes.size(); ++index)
+    {
+        isPassed = isPassed && population.individuals[index]->isEvaluated && population.individuals[index]->score == scores[index];
+    }
+
+    std::cout << name << ": " << (isPassed ? "passed" : "failed") << " (scores";
+    for (const FloatPopulation::GenomePointer &individual : population.individuals)
+    {
+        std::cout << " " << individual->score;
+    }
+    std::cout << ", failures " << evaluator.getFailures() << ", restarts " << evaluator.getRestarts() << ")" << std::endl;
+    return isPassed;
+}
+
+int main(int argc, char **argv)
+{
+    // One worker taking batches of 4, with a penalty score of -1
+    INIReader settings("subprocess.ini");
+    if (settings.ParseError() != 0)
+    {
+        std::cout << "Error: Unable to load subprocess.ini" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    SubprocessEvaluator<FloatPopulation> evaluator;
+    evaluator.parseSettings(settings);
+
+    bool isPassed = true;
+
+    // The crash is penalised, and 4 is sent again with the rest. The invalid individual is never sent
+    isPassed &= check(evaluator, "Crash", {"1", "2", "crash", "4", "", "6"}, {1, 2, -1, 4, -1, 6}, 1, 1);
+
+    // A reply that isn't a number is penalised
+    isPassed &= check(evaluator, "Garbage", {"7", "garbage", "9"}, {7, -1, 9}, 2, 2);
+
+    // A phenotype that takes longer than the timeout is penalised
+    isPassed &= check(evaluator, "Timeout", {"sleep", "11"}, {-1, 11}, 3, 3);
+
+    // A worker that ends while idle is restarted without penalising the next batch
+    isPassed &= check(evaluator, "Scored", {"quit"}, {0}, 3, 3);
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    isPassed &= check(evaluator, "Idle exit", {"13", "14"}, {13, 14}, 3, 4);
+
+    return isPassed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,337 @@
+#ifndef _BOOLEANCIRCUIT_CPP_
+#define _BOOLEANCIRCUIT_CPP_
+
+#include "BooleanCircuit.hpp"
+
+// Include system libraries
+#include <cctype>
+#include <cstring>
+
+// Default constructor
+BooleanCompiler::BooleanCompiler() : text(nullptr),
+                                     position(0),
+                                     tokenType(End),
+                                     circuit(nullptr)
+{
+}
+
+// Destructor
+BooleanCompiler::~BooleanCompiler()
+{
+}
+
+void BooleanCompiler::setInputs(const std::vector<std::string> &names)
+{
+    inputs.clear();
+    for (std::uint32_t index = 0; index < names.size(); ++index)
+    {
+        inputs.emplace(names[index], 2 + index);
+    }
+}
+
+bool BooleanCompiler::compile(const std::string &phenotype, BooleanCircuit::Circuit &circuit)
+{
+    circuit.inputCount = inputs.size();
+    circuit.gates.clear();
+    circuit.outputs.clear();
+    existing.clear();
+
+    this->text = &phenotype;
+    this->circuit = &circuit;
+    position = 0;
+    nextToken();
+
+    // Read the expression of each output
+    bool isValid = true;
+    while (isValid)
+    {
+        std::uint32_t signal;
+        isValid = parseOr(signal);
+        circuit.outputs.push_back(signal);
+
+        if (tokenType == End)
+        {
+            break;
+        }
+        isValid = isValid && isSymbol(';');
+        nextToken();
+    }
+
+    this->text = nullptr;
+    this->circuit = nullptr;
+    return isValid;
+}
+
+// Read the next name or symbol
+// Doubled symbols such as && and || are read as one
+void BooleanCompiler::nextToken()
+{
+    const std::string &text = *this->text;
+    while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+    {
+        ++position;
+    }
+
+    token.clear();
+    if (position >= text.size())
+    {
+        tokenType = End;
+        return;
+    }
+
+    char character = text[position];
+    if (std::isalnum(static_cast<unsigned char>(character)) || character == '_')
+    {
+        std::size_t begin = position;
+        while (position < text.size() && (std::isalnum(static_cast<unsigned char>(text[position])) || text[position] == '_'))
+        {
+            ++position;
+        }
+        tokenType = Name;
+        token = text.substr(begin, position - begin);
+    }
+    else
+    {
+        tokenType = Symbol;
+        token = character;
+        ++position;
+        if ((character == '&' || character == '|') && position < text.size() && text[position] == character)
+        {
+            ++position;
+        }
+    }
+}
+
+bool BooleanCompiler::isSymbol(const char symbol) const
+{
+    return tokenType == Symbol && token[0] == symbol;
+}
+
+bool BooleanCompiler::isWord(const char *word) const
+{
+    return tokenType == Name && token == word;
+}
+
+// or := xor (('|' | 'or') xor)*
+bool BooleanCompiler::parseOr(std::uint32_t &signal)
+{
+    if (!parseXor(signal))
+    {
+        return false;
+    }
+
+    while (isSymbol('|') || isWord("or"))
+    {
+        std::uint32_t right;
+        nextToken();
+        if (!parseXor(right))
+        {
+            return false;
+        }
+        signal = addGate(BooleanCircuit::Or, signal, right);
+    }
+    return true;
+}
+
+// xor := and (('^' | 'xor') and)*
+bool BooleanCompiler::parseXor(std::uint32_t &signal)
+{
+    if (!parseAnd(signal))
+    {
+        return false;
+    }
+
+    while (isSymbol('^') || isWord("xor"))
+    {
+        std::uint32_t right;
+        nextToken();
+        if (!parseAnd(right))
+        {
+            return false;
+        }
+        signal = addGate(BooleanCircuit::Xor, signal, right);
+    }
+    return true;
+}
+
+// and := unary (('&' | 'and') unary)*
+bool BooleanCompiler::parseAnd(std::uint32_t &signal)
+{
+    if (!parseUnary(signal))
+    {
+        return false;
+    }
+
+    while (isSymbol('&') || isWord("and"))
+    {
+        std::uint32_t right;
+        nextToken();
+        if (!parseUnary(right))
+        {
+            return false;
+        }
+        signal = addGate(BooleanCircuit::And, signal, right);
+    }
+    return true;
+}
+
+// unary := ('!' | '~' | 'not') unary | primary
+// not followed by a bracket is the function, which reads the same
+bool BooleanCompiler::parseUnary(std::uint32_t &signal)
+{
+    if (isSymbol('!') || isSymbol('~') || isWord("not"))
+    {
+        nextToken();
+        if (!parseUnary(signal))
+        {
+            return false;
+        }
+        signal = addGate(BooleanCircuit::Not, signal);
+        return true;
+    }
+    return parsePrimary(signal);
+}
+
+// primary := '0' | '1' | input | function '(' or (',' or)* ')' | '(' or ')'
+bool BooleanCompiler::parsePrimary(std::uint32_t &signal)
+{
+    if (isSymbol('('))
+    {
+        nextToken();
+        if (!parseOr(signal) || !isSymbol(')'))
+        {
+            return false;
+        }
+        nextToken();
+        return true;
+    }
+
+    if (tokenType != Name)
+    {
+        return false;
+    }
+
+    if (token == "0" || token == "false")
+    {
+        signal = 0;
+        nextToken();
+        return true;
+    }
+
+    if (token == "1" || token == "true")
+    {
+        signal = 1;
+        nextToken();
+        return true;
+    }
+
+    std::unordered_map<std::string, std::uint32_t>::const_iterator input = inputs.find(token);
+    if (input != inputs.end())
+    {
+        signal = input->second;
+        nextToken();
+        return true;
+    }
+
+    // Find the function and its number of arguments
+    static const struct
+    {
+        const char *name;
+        BooleanCircuit::GateType type;
+        unsigned int argumentCount;
+    } functions[] = {
+        {"and", BooleanCircuit::And, 2},
+        {"or", BooleanCircuit::Or, 2},
+        {"xor", BooleanCircuit::Xor, 2},
+        {"nand", BooleanCircuit::Nand, 2},
+        {"nor", BooleanCircuit::Nor, 2},
+        {"xnor", BooleanCircuit::Xnor, 2},
+        {"if", BooleanCircuit::Mux, 3},
+        {"mux", BooleanCircuit::Mux, 3}};
+
+    const auto *function = std::find_if(std::begin(functions), std::end(functions), [this](const auto &function)
+                                        { return token == function.name; });
+    if (function == std::end(functions))
+    {
+        return false;
+    }
+
+    nextToken();
+    if (!isSymbol('('))
+    {
+        return false;
+    }
+    nextToken();
+
+    std::uint32_t arguments[3] = {0, 0, 0};
+    for (unsigned int argument = 0; argument < function->argumentCount; ++argument)
+    {
+        if (argument > 0)
+        {
+            if (!isSymbol(','))
+            {
+                return false;
+            }
+            nextToken();
+        }
+
+        if (!parseOr(arguments[argument]))
+        {
+            return false;
+        }
+    }
+
+    if (!isSymbol(')'))
+    {
+        return false;
+    }
+    nextToken();
+
+    signal = addGate(function->type, arguments[0], arguments[1], arguments[2]);
+    return true;
+}
+
+// Add a gate, unless its value is already known
+std::uint32_t BooleanCompiler::addGate(BooleanCircuit::GateType type, std::uint32_t a, std::uint32_t b, std::uint32_t c)
+{
+    // Gates of constants are worked out now
+    if (a < 2 && b < 2 && c < 2)
+    {
+        switch (type)
+        {
+        case BooleanCircuit::And:
+            return a & b;
+        case BooleanCircuit::Or:
+            return a | b;
+        case BooleanCircuit::Xor:
+            return a ^ b;
+        case BooleanCircuit::Nand:
+            return !(a & b);
+        case BooleanCircuit::Nor:
+            return !(a | b);
+        case BooleanCircuit::Xnor:
+            return !(a ^ b);
+        case BooleanCircuit::Not:
+            return !a;
+        default:
+            return a ? b : c;
+        }
+    }
+
+    // Gates with the same inputs the other way round are the same gate
+    if (type != BooleanCircuit::Mux && type != BooleanCircuit::Not && b < a)
+    {
+        std::swap(a, b);
+    }
+
+    std::map<std::array<std::uint32_t, 4>, std::uint32_t>::iterator found;
+    bool isNew;
+    std::tie(found, isNew) = existing.emplace(std::array<std::uint32_t, 4>{type, a, b, c}, circuit->getSignalCount());
+    if (isNew)
+    {
+        circuit->gates.push_back(BooleanCircuit::Gate{type, a, b, c});
+    }
+    return found->second;
+}
+
+#endif
@@ -0,0 +1,379 @@
+#ifndef _BOOLEANCIRCUIT_HPP_
+#define _BOOLEANCIRCUIT_HPP_
+
+// Include system libraries
+#include <vector>
+#include <string>
+#include <map>
+#include <array>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <tuple>
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Gate list for Boolean expressions
+// Every value in a circuit is a signal. Signals 0 and 1 are the constants false and true,
+// the inputs come next, then one signal for the output of each gate, in the order they are listed.
+// A gate only reads signals before its own, so the gates can be worked out in order.
+namespace BooleanCircuit
+{
+    enum GateType : std::uint8_t
+    {
+        And,
+        Or,
+        Xor,
+        Nand,
+        Nor,
+        Xnor,
+        Not,
+        Mux // If a then b else c
+    };
+
+    struct Gate
+    {
+        GateType type;
+        std::uint32_t a;
+        std::uint32_t b;
+        std::uint32_t c;
+    };
+
+    struct Circuit
+    {
+        unsigned int inputCount = 0;
+        std::vector<Gate> gates;
+        std::vector<std::uint32_t> outputs; // Signal of each output
+
+        std::uint32_t getSignalCount() const { return 2 + inputCount + gates.size(); }
+    };
+}
+
+// This class compiles the text of a Boolean phenotype into a gate list.
+// Expressions use the operators & | ^ and !, the words and, or, xor and not, the functions
+// and, or, xor, nand, nor, xnor, not and if(condition, then, else), brackets, the inputs, and 0 and 1.
+// A phenotype with several outputs separates their expressions with ';'.
+// Gates that repeat an earlier gate, or whose inputs are all constants, aren't added.
+class BooleanCompiler
+{
+public:
+    BooleanCompiler();  // Default constructor
+    ~BooleanCompiler(); // Destructor
+
+    // Set the names of the inputs, which are numbered in order
+    void setInputs(const std::vector<std::string> &names);
+
+    // Compile the phenotype, returning false if it isn't a valid expression
+    bool compile(const std::string &phenotype, BooleanCircuit::Circuit &circuit);
+
+private:
+    enum TokenType
+    {
+        Name,
+        Symbol,
+        End
+    };
+
+    // Work methods
+    void nextToken();
+    bool isSymbol(const char symbol) const;
+    bool isWord(const char *word) const;
+    bool parseOr(std::uint32_t &signal);
+    bool parseXor(std::uint32_t &signal);
+    bool parseAnd(std::uint32_t &signal);
+    bool parseUnary(std::uint32_t &signal);
+    bool parsePrimary(std::uint32_t &signal);
+    std::uint32_t addGate(BooleanCircuit::GateType type, std::uint32_t a, std::uint32_t b = 0, std::uint32_t c = 0);
+
+    // Private variables
+    std::unordered_map<std::string, std::uint32_t> inputs; // Signal of each input
+
+    // Parser state
+    const std::string *text;
+    std::size_t position;
+    TokenType tokenType;
+    std::string token;
+    BooleanCircuit::Circuit *circuit;
+    std::map<std::array<std::uint32_t, 4>, std::uint32_t> existing; // Signal of each gate already added
+};
+
+// This class holds the full truth table of a problem and counts the rows a circuit gets right.
+// Rows are packed 64 to a word, so each gate works out 64 rows with one bitwise instruction, and
+// a block of words is worked out at a time with AVX-512 or AVX2 when the compiler targets them.
+// Inputs aren't stored, as input i of row r is bit i of r: each word of the first six inputs is a fixed
+// pattern, and the other inputs are all zeros or all ones across a word.
+class TruthTable
+{
+public:
+    static constexpr std::size_t blockWords = 64; // Words worked out at a time, a multiple of every vector width
+
+    TruthTable();  // Default constructor
+    ~TruthTable(); // Destructor
+
+    // Make the table for every combination of the inputs
+    // target(row) gives the outputs of a row, with output i in bit i
+    template <class FUNCTION>
+    void setTargets(const unsigned int inputCount, const unsigned int outputCount, FUNCTION target);
+
+    // Count the output bits the circuit gets right over every row
+    // A circuit with the wrong number of inputs or outputs gets none right
+    std::uint64_t countHits(const BooleanCircuit::Circuit &circuit);
+
+    // Get methods
+    unsigned int getInputCount() const;
+    unsigned int getOutputCount() const;
+    std::uint64_t getRowCount() const;
+    std::uint64_t getMaxHits() const; // Hits of a perfect circuit
+
+private:
+    // Work methods
+    void fillInputs(const std::size_t firstWord, const std::size_t count);
+    std::uint64_t *getSignal(const std::uint32_t signal);
+
+    // Private variables
+    unsigned int inputCount;
+    unsigned int outputCount;
+    std::uint64_t rowCount;
+    std::size_t wordCount;
+    std::uint64_t lastMask;                          // Rows used in the last word
+    std::vector<std::vector<std::uint64_t>> targets; // Words of each output
+    std::vector<std::uint64_t> signals;              // One block of words for each signal
+};
+
+// Vector operations for the truth table, on the widest vectors the compiler targets
+namespace BitVector
+{
+#if defined(__AVX512F__)
+    using Vector = __m512i;
+    constexpr std::size_t width = 8;
+    inline Vector load(const std::uint64_t *p) { return _mm512_loadu_si512(p); }
+    inline void store(std::uint64_t *p, Vector v) { _mm512_storeu_si512(p, v); }
+    inline Vector bitAnd(Vector a, Vector b) { return _mm512_and_si512(a, b); }
+    inline Vector bitOr(Vector a, Vector b) { return _mm512_or_si512(a, b); }
+    inline Vector bitXor(Vector a, Vector b) { return _mm512_xor_si512(a, b); }
+    inline Vector bitAndNot(Vector a, Vector b) { return _mm512_andnot_si512(a, b); } // ~a & b
+    inline Vector ones() { return _mm512_set1_epi64(-1); }
+#elif defined(__AVX2__)
+    using Vector = __m256i;
+    constexpr std::size_t width = 4;
+    inline Vector load(const std::uint64_t *p) { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p)); }
+    inline void store(std::uint64_t *p, Vector v) { _mm256_storeu_si256(reinterpret_cast<__m256i *>(p), v); }
+    inline Vector bitAnd(Vector a, Vector b) { return _mm256_and_si256(a, b); }
+    inline Vector bitOr(Vector a, Vector b) { return _mm256_or_si256(a, b); }
+    inline Vector bitXor(Vector a, Vector b) { return _mm256_xor_si256(a, b); }
+    inline Vector bitAndNot(Vector a, Vector b) { return _mm256_andnot_si256(a, b); }
+    inline Vector ones() { return _mm256_set1_epi64x(-1); }
+#else
+    using Vector = std::uint64_t;
+    constexpr std::size_t width = 1;
+    inline Vector load(const std::uint64_t *p) { return *p; }
+    inline void store(std::uint64_t *p, Vector v) { *p = v; }
+    inline Vector bitAnd(Vector a, Vector b) { return a & b; }
+    inline Vector bitOr(Vector a, Vector b) { return a | b; }
+    inline Vector bitXor(Vector a, Vector b) { return a ^ b; }
+    inline Vector bitAndNot(Vector a, Vector b) { return ~a & b; }
+    inline Vector ones() { return ~std::uint64_t(0); }
+#endif
+
+    // Apply the operation to the first count words, a multiple of the vector width
+    template <class OPERATION>
+    inline void apply(std::uint64_t *out, const std::uint64_t *a, const std::uint64_t *b, const std::uint64_t *c, const std::size_t count, OPERATION operation)
+    {
+        for (std::size_t i = 0; i < count; i += width)
+        {
+            store(out + i, operation(load(a + i), load(b + i), load(c + i)));
+        }
+    }
+}
+
+// Default constructor
+inline TruthTable::TruthTable() : inputCount(0),
+                                  outputCount(0),
+                                  rowCount(0),
+                                  wordCount(0),
+                                  lastMask(0)
+{
+}
+
+// Destructor
+inline TruthTable::~TruthTable()
+{
+}
+
+template <class FUNCTION>
+void TruthTable::setTargets(const unsigned int inputCount, const unsigned int outputCount, FUNCTION target)
+{
+    this->inputCount = inputCount;
+    this->outputCount = outputCount;
+    rowCount = std::uint64_t(1) << inputCount;
+    wordCount = (rowCount + 63) / 64;
+    lastMask = rowCount % 64 == 0 ? ~std::uint64_t(0) : (std::uint64_t(1) << rowCount % 64) - 1;
+
+    targets.assign(outputCount, std::vector<std::uint64_t>(wordCount, 0));
+    for (std::uint64_t row = 0; row < rowCount; ++row)
+    {
+        std::uint64_t outputs = target(row);
+        for (unsigned int output = 0; output < outputCount; ++output)
+        {
+            targets[output][row / 64] |= ((outputs >> output) & 1) << (row % 64);
+        }
+    }
+}
+
+inline std::uint64_t TruthTable::countHits(const BooleanCircuit::Circuit &circuit)
+{
+    using namespace BitVector;
+
+    if (circuit.inputCount != inputCount || circuit.outputs.size() != outputCount)
+    {
+        return 0;
+    }
+
+    signals.resize(circuit.getSignalCount() * blockWords);
+    std::fill(getSignal(0), getSignal(0) + blockWords, 0);
+    std::fill(getSignal(1), getSignal(1) + blockWords, ~std::uint64_t(0));
+
+    std::uint64_t hits = 0;
+    for (std::size_t firstWord = 0; firstWord < wordCount; firstWord += blockWords)
+    {
+        std::size_t count = std::min(blockWords, wordCount - firstWord);
+        fillInputs(firstWord, count);
+
+        // Work out every gate over the block
+        std::size_t vectorWords = (count + width - 1) / width * width;
+        std::uint32_t signal = 2 + inputCount;
+        for (const BooleanCircuit::Gate &gate : circuit.gates)
+        {
+            std::uint64_t *out = getSignal(signal++);
+            const std::uint64_t *a = getSignal(gate.a);
+            const std::uint64_t *b = getSignal(gate.b);
+            const std::uint64_t *c = getSignal(gate.c);
+
+            switch (gate.type)
+            {
+            case BooleanCircuit::And:
+                apply(out, a, b, c, vectorWords, [](Vector x, Vector y, Vector)
+                      { return bitAnd(x, y); });
+                break;
+            case BooleanCircuit::Or:
+                apply(out, a, b, c, vectorWords, [](Vector x, Vector y, Vector)
+                      { return bitOr(x, y); });
+                break;
+            case BooleanCircuit::Xor:
+                apply(out, a, b, c, vectorWords, [](Vector x, Vector y, Vector)
+                      { return bitXor(x, y); });
+                break;
+            case BooleanCircuit::Nand:
+                apply(out, a, b, c, vectorWords, [](Vector x, Vector y, Vector)
+                      { return bitXor(bitAnd(x, y), ones()); });
+                break;
+            case BooleanCircuit::Nor:
+                apply(out, a, b, c, vectorWords, [](Vector x, Vector y, Vector)
+                      { return bitXor(bitOr(x, y), ones()); });
+                break;
+            case BooleanCircuit::Xnor:
+                apply(out, a, b, c, vectorWords, [](Vector x, Vector y, Vector)
+                      { return bitXor(bitXor(x, y), ones()); });
+                break;
+            case BooleanCircuit::Not:
+                apply(out, a, b, c, vectorWords, [](Vector x, Vector, Vector)
+                      { return bitXor(x, ones()); });
+                break;
+            default:
+                apply(out, a, b, c, vectorWords, [](Vector x, Vector y, Vector z)
+                      { return bitOr(bitAnd(x, y), bitAndNot(x, z)); });
+                break;
+            }
+        }
+
+        // Count the rows where each output matches its target
+        for (unsigned int output = 0; output < outputCount; ++output)
+        {
+            const std::uint64_t *values = getSignal(circuit.outputs[output]);
+            const std::uint64_t *target = targets[output].data() + firstWord;
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                hits += __builtin_popcountll(~(values[i] ^ target[i]));
+            }
+
+            // Take off the rows past the end of the table
+            if (firstWord + count == wordCount)
+            {
+                hits -= __builtin_popcountll(~(values[count - 1] ^ target[count - 1]) & ~lastMask);
+            }
+        }
+    }
+    return hits;
+}
+
+// Get methods
+inline unsigned int TruthTable::getInputCount() const
+{
+    return inputCount;
+}
+
+inline unsigned int TruthTable::getOutputCount() const
+{
+    return outputCount;
+}
+
+inline std::uint64_t TruthTable::getRowCount() const
+{
+    return rowCount;
+}
+
+inline std::uint64_t TruthTable::getMaxHits() const
+{
+    return rowCount * outputCount;
+}
+
+// Write the words of the inputs for a block
+// Blocks start at a multiple of 64 words, so the first twelve inputs are the same in every block,
+// and the others are the same across a block
+inline void TruthTable::fillInputs(const std::size_t firstWord, const std::size_t count)
+{
+    // Bit i of the row within a word repeats with a period of 2^(i+1) rows
+    static const std::uint64_t patterns[6] = {
+        0xAAAAAAAAAAAAAAAAULL,
+        0xCCCCCCCCCCCCCCCCULL,
+        0xF0F0F0F0F0F0F0F0ULL,
+        0xFF00FF00FF00FF00ULL,
+        0xFFFF0000FFFF0000ULL,
+        0xFFFFFFFF00000000ULL};
+
+    for (unsigned int input = 0; input < inputCount; ++input)
+    {
+        std::uint64_t *words = getSignal(2 + input);
+        if (input >= 12)
+        {
+            std::fill(words, words + blockWords, (firstWord >> (input - 6)) & 1 ? ~std::uint64_t(0) : 0);
+        }
+        else if (firstWord == 0)
+        {
+            for (std::size_t i = 0; i < blockWords; ++i)
+            {
+                if (i >= count)
+                {
+                    words[i] = 0;
+                }
+                else if (input < 6)
+                {
+                    words[i] = patterns[input];
+                }
+                else
+                {
+                    words[i] = (i >> (input - 6)) & 1 ? ~std::uint64_t(0) : 0;
+                }
+            }
+        }
+    }
+}
+
+inline std::uint64_t *TruthTable::getSignal(const std::uint32_t signal)
+{
+    return signals.data() + signal * blockWords;
+}
+
+#endif
@@ -0,0 +1,158 @@
+#ifndef _BULKRANDOM_HPP_
+#define _BULKRANDOM_HPP_
+
+// Include system libraries
+#include <cstdint>
+#include <cstddef>
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Include utility classes
+#include "RandomEngines.hpp"
+
+// This class fills whole buffers with random numbers using 8 xoshiro256++ generators side by side.
+// The 8 lanes are stepped with AVX-512 or AVX2 when available, otherwise one at a time.
+// The lanes are laid out the same way in every case, so a seed gives the same numbers on any machine.
+class BulkRandom
+{
+public:
+    BulkRandom(const std::uint64_t seed = 0); // Default constructor
+
+    // Seed the lanes from a single seed
+    void seed(const std::uint64_t seed);
+
+    // Fill the buffer with codons between 0 and 255
+    void fillCodons(unsigned int *codons, const std::size_t count);
+
+    // Fill the buffer with probabilities between 0 and 1, excluding 1
+    void fillUniform(float *values, const std::size_t count);
+
+    // Get the next 64 bits from each lane
+    void next(std::uint64_t *output);
+
+private:
+    static constexpr unsigned int lanes = 8;
+
+    // State word i of lane j is state[i][j]
+    alignas(64) std::uint64_t state[4][lanes];
+    alignas(64) std::uint64_t block[lanes];
+};
+
+// Default constructor
+inline BulkRandom::BulkRandom(const std::uint64_t seed)
+{
+    this->seed(seed);
+}
+
+// Each lane is seeded from its own SplitMix64 sequence
+inline void BulkRandom::seed(const std::uint64_t seed)
+{
+    SplitMix64 seeder(seed);
+    for (unsigned int lane = 0; lane < lanes; ++lane)
+    {
+        for (unsigned int word = 0; word < 4; ++word)
+        {
+            state[word][lane] = seeder();
+        }
+    }
+}
+
+// Every byte of the output is a codon, so a block gives 64 codons
+inline void BulkRandom::fillCodons(unsigned int *codons, const std::size_t count)
+{
+    std::size_t index = 0;
+    while (index < count)
+    {
+        next(block);
+        for (unsigned int byte = 0; byte < lanes * 8 && index < count; ++byte, ++index)
+        {
+            codons[index] = (block[byte % lanes] >> (8 * (byte / lanes))) & 0xFF;
+        }
+    }
+}
+
+// Each 64 bit output gives two 24 bit probabilities
+inline void BulkRandom::fillUniform(float *values, const std::size_t count)
+{
+    const float scale = 1.0f / (1u << 24);
+
+    std::size_t index = 0;
+    while (index < count)
+    {
+        next(block);
+        for (unsigned int half = 0; half < lanes * 2 && index < count; ++half, ++index)
+        {
+            values[index] = ((block[half % lanes] >> (half < lanes ? 40 : 8)) & 0xFFFFFF) * scale;
+        }
+    }
+}
+
+// Step every lane once
+inline void BulkRandom::next(std::uint64_t *output)
+{
+#if defined(__AVX512F__)
+    __m512i s0 = _mm512_load_si512(state[0]);
+    __m512i s1 = _mm512_load_si512(state[1]);
+    __m512i s2 = _mm512_load_si512(state[2]);
+    __m512i s3 = _mm512_load_si512(state[3]);
+
+    __m512i result = _mm512_add_epi64(_mm512_rol_epi64(_mm512_add_epi64(s0, s3), 23), s0);
+    __m512i t = _mm512_slli_epi64(s1, 17);
+
+    s2 = _mm512_xor_si512(s2, s0);
+    s3 = _mm512_xor_si512(s3, s1);
+    s1 = _mm512_xor_si512(s1, s2);
+    s0 = _mm512_xor_si512(s0, s3);
+    s2 = _mm512_xor_si512(s2, t);
+    s3 = _mm512_rol_epi64(s3, 45);
+
+    _mm512_store_si512(state[0], s0);
+    _mm512_store_si512(state[1], s1);
+    _mm512_store_si512(state[2], s2);
+    _mm512_store_si512(state[3], s3);
+    _mm512_storeu_si512(output, result);
+#elif defined(__AVX2__)
+    // Two halves of 4 lanes, rotating with a pair of shifts
+    for (unsigned int half = 0; half < lanes; half += 4)
+    {
+        __m256i s0 = _mm256_load_si256(reinterpret_cast<const __m256i *>(&state[0][half]));
+        __m256i s1 = _mm256_load_si256(reinterpret_cast<const __m256i *>(&state[1][half]));
+        __m256i s2 = _mm256_load_si256(reinterpret_cast<const __m256i *>(&state[2][half]));
+        __m256i s3 = _mm256_load_si256(reinterpret_cast<const __m256i *>(&state[3][half]));
+
+        __m256i sum = _mm256_add_epi64(s0, s3);
+        __m256i result = _mm256_add_epi64(_mm256_or_si256(_mm256_slli_epi64(sum, 23), _mm256_srli_epi64(sum, 41)), s0);
+        __m256i t = _mm256_slli_epi64(s1, 17);
+
+        s2 = _mm256_xor_si256(s2, s0);
+        s3 = _mm256_xor_si256(s3, s1);
+        s1 = _mm256_xor_si256(s1, s2);
+        s0 = _mm256_xor_si256(s0, s3);
+        s2 = _mm256_xor_si256(s2, t);
+        s3 = _mm256_or_si256(_mm256_slli_epi64(s3, 45), _mm256_srli_epi64(s3, 19));
+
+        _mm256_store_si256(reinterpret_cast<__m256i *>(&state[0][half]), s0);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(&state[1][half]), s1);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(&state[2][half]), s2);
+        _mm256_store_si256(reinterpret_cast<__m256i *>(&state[3][half]), s3);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(&output[half]), result);
+    }
+#else
+    for (unsigned int lane = 0; lane < lanes; ++lane)
+    {
+        std::uint64_t sum = state[0][lane] + state[3][lane];
+        std::uint64_t t = state[1][lane] << 17;
+        output[lane] = ((sum << 23) | (sum >> 41)) + state[0][lane];
+
+        state[2][lane] ^= state[0][lane];
+        state[3][lane] ^= state[1][lane];
+        state[1][lane] ^= state[2][lane];
+        state[0][lane] ^= state[3][lane];
+        state[2][lane] ^= t;
+        state[3][lane] = (state[3][lane] << 45) | (state[3][lane] >> 19);
+    }
+#endif
+}
+
+#endif
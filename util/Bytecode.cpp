@@ -0,0 +1,517 @@
+#ifndef _BYTECODE_CPP_
+#define _BYTECODE_CPP_
+
+#include "Bytecode.hpp"
+
+// Include system libraries
+#include <cctype>
+#include <cstdlib>
+#include <cstdio>
+
+namespace
+{
+    struct OperatorName
+    {
+        const char *name;
+        Bytecode::Opcode opcode;
+    };
+
+    // Names used to declare the operators, and to call the functions
+    const OperatorName operatorNames[] = {
+        {"+", Bytecode::Add},
+        {"-", Bytecode::Subtract},
+        {"*", Bytecode::Multiply},
+        {"/", Bytecode::Divide},
+        {"^", Bytecode::Power},
+        {"neg", Bytecode::Negate},
+        {"min", Bytecode::Minimum},
+        {"max", Bytecode::Maximum},
+        {"pow", Bytecode::Power},
+        {"sin", Bytecode::Sin},
+        {"cos", Bytecode::Cos},
+        {"exp", Bytecode::Exp},
+        {"log", Bytecode::Log},
+        {"sqrt", Bytecode::Sqrt},
+        {"abs", Bytecode::Abs},
+        {"tanh", Bytecode::Tanh}};
+
+    const unsigned int opcodeCount = Bytecode::Tanh + 1;
+
+    bool isBinary(const Bytecode::Opcode opcode)
+    {
+        return opcode >= Bytecode::Add && opcode <= Bytecode::Maximum;
+    }
+
+    // Work out an operator on constants, in the same precision as the interpreter
+    float fold(const Bytecode::Opcode opcode, const float a, const float b)
+    {
+        switch (opcode)
+        {
+        case Bytecode::Add:
+            return a + b;
+        case Bytecode::Subtract:
+            return a - b;
+        case Bytecode::Multiply:
+            return a * b;
+        case Bytecode::Divide:
+            return a / b;
+        case Bytecode::Power:
+            return std::pow(a, b);
+        case Bytecode::Minimum:
+            return a < b ? a : b;
+        case Bytecode::Maximum:
+            return a > b ? a : b;
+        case Bytecode::Negate:
+            return -a;
+        case Bytecode::Sin:
+            return std::sin(a);
+        case Bytecode::Cos:
+            return std::cos(a);
+        case Bytecode::Exp:
+            return std::exp(a);
+        case Bytecode::Log:
+            return std::log(a);
+        case Bytecode::Sqrt:
+            return std::sqrt(a);
+        case Bytecode::Abs:
+            return std::fabs(a);
+        default:
+            return std::tanh(a);
+        }
+    }
+}
+
+// Default constructor
+BytecodeCompiler::BytecodeCompiler() : allowed(opcodeCount, true),
+                                       text(nullptr),
+                                       position(0),
+                                       tokenType(End),
+                                       tokenValue(0.0f),
+                                       program(nullptr),
+                                       depth(0)
+{
+}
+
+// Destructor
+BytecodeCompiler::~BytecodeCompiler()
+{
+}
+
+void BytecodeCompiler::setVariables(const std::vector<std::string> &names)
+{
+    variables.clear();
+    for (std::uint32_t index = 0; index < names.size(); ++index)
+    {
+        variables.emplace(names[index], index);
+    }
+}
+
+void BytecodeCompiler::setOperators(const std::vector<std::string> &names)
+{
+    std::fill(allowed.begin(), allowed.end(), false);
+    for (const std::string &name : names)
+    {
+        for (const OperatorName &operatorName : operatorNames)
+        {
+            if (name == operatorName.name)
+            {
+                allowed[operatorName.opcode] = true;
+            }
+        }
+
+        // Subtraction also allows unary minus
+        if (name == "-")
+        {
+            allowed[Bytecode::Negate] = true;
+        }
+    }
+}
+
+std::vector<std::string> BytecodeCompiler::getOperatorNames()
+{
+    std::vector<std::string> names;
+    for (const OperatorName &operatorName : operatorNames)
+    {
+        names.push_back(operatorName.name);
+    }
+    return names;
+}
+
+// Rebuild the expression from the postfix code, bracketing every operator
+std::string BytecodeCompiler::toC(const Bytecode::Program &program, const std::string &index)
+{
+    std::vector<std::string> stack;
+    for (const Bytecode::Instruction &instruction : program.code)
+    {
+        if (instruction.opcode == Bytecode::PushVariable)
+        {
+            stack.push_back("column" + std::to_string(instruction.operand) + "[" + index + "]");
+            continue;
+        }
+
+        if (instruction.opcode == Bytecode::PushConstant)
+        {
+            // Hexadecimal keeps the constant exact
+            float value = program.constants[instruction.operand];
+            if (std::isnan(value))
+            {
+                stack.push_back("__builtin_nanf(\"\")");
+            }
+            else if (std::isinf(value))
+            {
+                stack.push_back(value > 0.0f ? "__builtin_inff()" : "(-__builtin_inff())");
+            }
+            else
+            {
+                char buffer[32];
+                std::snprintf(buffer, sizeof(buffer), "%af", static_cast<double>(value));
+                stack.push_back(std::string("(") + buffer + ")");
+            }
+            continue;
+        }
+
+        if (isBinary(instruction.opcode))
+        {
+            std::string b = std::move(stack.back());
+            stack.pop_back();
+            std::string &a = stack.back();
+            switch (instruction.opcode)
+            {
+            case Bytecode::Add:
+                a = "(" + a + " + " + b + ")";
+                break;
+            case Bytecode::Subtract:
+                a = "(" + a + " - " + b + ")";
+                break;
+            case Bytecode::Multiply:
+                a = "(" + a + " * " + b + ")";
+                break;
+            case Bytecode::Divide:
+                a = "(" + a + " / " + b + ")";
+                break;
+            case Bytecode::Power:
+                a = "powf(" + a + ", " + b + ")";
+                break;
+            case Bytecode::Minimum:
+                a = "grace_min(" + a + ", " + b + ")";
+                break;
+            default:
+                a = "grace_max(" + a + ", " + b + ")";
+                break;
+            }
+            continue;
+        }
+
+        std::string &a = stack.back();
+        switch (instruction.opcode)
+        {
+        case Bytecode::Negate:
+            a = "(-" + a + ")";
+            break;
+        case Bytecode::Sin:
+            a = "sinf(" + a + ")";
+            break;
+        case Bytecode::Cos:
+            a = "cosf(" + a + ")";
+            break;
+        case Bytecode::Exp:
+            a = "expf(" + a + ")";
+            break;
+        case Bytecode::Log:
+            a = "logf(" + a + ")";
+            break;
+        case Bytecode::Sqrt:
+            a = "sqrtf(" + a + ")";
+            break;
+        case Bytecode::Abs:
+            a = "fabsf(" + a + ")";
+            break;
+        default:
+            a = "tanhf(" + a + ")";
+            break;
+        }
+    }
+    return stack.empty() ? "" : stack.back();
+}
+
+bool BytecodeCompiler::compile(const std::string &expression, Bytecode::Program &program)
+{
+    program.code.clear();
+    program.constants.clear();
+    program.stackSize = 0;
+
+    this->text = &expression;
+    this->program = &program;
+    position = 0;
+    depth = 0;
+    nextToken();
+
+    // The whole expression must be used, leaving one value on the stack
+    bool isValid = parseExpression() && tokenType == End && depth == 1;
+
+    this->text = nullptr;
+    this->program = nullptr;
+    return isValid;
+}
+
+// Read the next number, name or symbol
+void BytecodeCompiler::nextToken()
+{
+    const std::string &text = *this->text;
+    while (position < text.size() && std::isspace(static_cast<unsigned char>(text[position])))
+    {
+        ++position;
+    }
+
+    token.clear();
+    if (position >= text.size())
+    {
+        tokenType = End;
+        return;
+    }
+
+    char character = text[position];
+    if (std::isdigit(static_cast<unsigned char>(character)) || character == '.')
+    {
+        const char *begin = text.c_str() + position;
+        char *end;
+        tokenValue = std::strtof(begin, &end);
+        if (end == begin)
+        {
+            // A lone '.' is a symbol the parser won't accept
+            tokenType = Symbol;
+            token = character;
+            ++position;
+            return;
+        }
+        tokenType = Number;
+        position += end - begin;
+    }
+    else if (std::isalpha(static_cast<unsigned char>(character)) || character == '_')
+    {
+        std::size_t begin = position;
+        while (position < text.size() && (std::isalnum(static_cast<unsigned char>(text[position])) || text[position] == '_'))
+        {
+            ++position;
+        }
+        tokenType = Name;
+        token = text.substr(begin, position - begin);
+    }
+    else
+    {
+        tokenType = Symbol;
+        token = character;
+        ++position;
+    }
+}
+
+bool BytecodeCompiler::isSymbol(const char symbol) const
+{
+    return tokenType == Symbol && token[0] == symbol;
+}
+
+// expression := term (('+' | '-') term)*
+bool BytecodeCompiler::parseExpression()
+{
+    if (!parseTerm())
+    {
+        return false;
+    }
+
+    while (isSymbol('+') || isSymbol('-'))
+    {
+        Bytecode::Opcode opcode = isSymbol('+') ? Bytecode::Add : Bytecode::Subtract;
+        nextToken();
+        if (!parseTerm() || !emit(opcode))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// term := unary (('*' | '/') unary)*
+bool BytecodeCompiler::parseTerm()
+{
+    if (!parseUnary())
+    {
+        return false;
+    }
+
+    while (isSymbol('*') || isSymbol('/'))
+    {
+        Bytecode::Opcode opcode = isSymbol('*') ? Bytecode::Multiply : Bytecode::Divide;
+        nextToken();
+        if (!parseUnary() || !emit(opcode))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+// unary := ('-' | '+') unary | power
+bool BytecodeCompiler::parseUnary()
+{
+    if (isSymbol('-'))
+    {
+        nextToken();
+        return parseUnary() && emit(Bytecode::Negate);
+    }
+
+    if (isSymbol('+'))
+    {
+        nextToken();
+        return parseUnary();
+    }
+
+    return parsePower();
+}
+
+// power := primary ('^' unary)?
+bool BytecodeCompiler::parsePower()
+{
+    if (!parsePrimary())
+    {
+        return false;
+    }
+
+    if (isSymbol('^'))
+    {
+        nextToken();
+        return parseUnary() && emit(Bytecode::Power);
+    }
+    return true;
+}
+
+// primary := number | variable | function '(' expression (',' expression)* ')' | '(' expression ')'
+bool BytecodeCompiler::parsePrimary()
+{
+    if (tokenType == Number)
+    {
+        emitConstant(tokenValue);
+        nextToken();
+        return true;
+    }
+
+    if (isSymbol('('))
+    {
+        nextToken();
+        if (!parseExpression() || !isSymbol(')'))
+        {
+            return false;
+        }
+        nextToken();
+        return true;
+    }
+
+    if (tokenType != Name)
+    {
+        return false;
+    }
+
+    // Variables are looked up first, so a column may be named like a function
+    std::unordered_map<std::string, std::uint32_t>::const_iterator variable = variables.find(token);
+    if (variable != variables.end())
+    {
+        program->code.push_back(Bytecode::Instruction{Bytecode::PushVariable, variable->second});
+        program->stackSize = std::max(program->stackSize, ++depth);
+        nextToken();
+        return true;
+    }
+
+    const OperatorName *function = nullptr;
+    for (const OperatorName &operatorName : operatorNames)
+    {
+        if (token == operatorName.name)
+        {
+            function = &operatorName;
+        }
+    }
+
+    if (!function)
+    {
+        return false;
+    }
+
+    nextToken();
+    if (!isSymbol('('))
+    {
+        return false;
+    }
+    nextToken();
+
+    unsigned int argumentCount = isBinary(function->opcode) ? 2 : 1;
+    for (unsigned int argument = 0; argument < argumentCount; ++argument)
+    {
+        if (argument > 0)
+        {
+            if (!isSymbol(','))
+            {
+                return false;
+            }
+            nextToken();
+        }
+
+        if (!parseExpression())
+        {
+            return false;
+        }
+    }
+
+    if (!isSymbol(')'))
+    {
+        return false;
+    }
+    nextToken();
+    return emit(function->opcode);
+}
+
+// Add an operator to the program, working it out now if its operands are constants
+bool BytecodeCompiler::emit(const Bytecode::Opcode opcode)
+{
+    if (!isAllowed(opcode))
+    {
+        return false;
+    }
+
+    std::vector<Bytecode::Instruction> &code = program->code;
+    unsigned int operandCount = isBinary(opcode) ? 2 : 1;
+
+    if (code.size() >= operandCount &&
+        code[code.size() - 1].opcode == Bytecode::PushConstant &&
+        (operandCount == 1 || code[code.size() - 2].opcode == Bytecode::PushConstant))
+    {
+        float b = program->constants[code.back().operand];
+        float a = operandCount == 2 ? program->constants[code[code.size() - 2].operand] : b;
+        float value = operandCount == 2 ? fold(opcode, a, b) : fold(opcode, b, 0.0f);
+
+        // The folded constants are always the last ones added
+        for (unsigned int operand = 0; operand < operandCount; ++operand)
+        {
+            code.pop_back();
+            program->constants.pop_back();
+        }
+        depth -= operandCount;
+        emitConstant(value);
+        return true;
+    }
+
+    code.push_back(Bytecode::Instruction{opcode, 0});
+    depth -= operandCount - 1;
+    return true;
+}
+
+void BytecodeCompiler::emitConstant(const float value)
+{
+    program->code.push_back(Bytecode::Instruction{Bytecode::PushConstant, static_cast<std::uint32_t>(program->constants.size())});
+    program->constants.push_back(value);
+    program->stackSize = std::max(program->stackSize, ++depth);
+}
+
+bool BytecodeCompiler::isAllowed(const Bytecode::Opcode opcode) const
+{
+    return allowed[opcode];
+}
+
+#endif
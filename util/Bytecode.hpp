@@ -0,0 +1,420 @@
+#ifndef _BYTECODE_HPP_
+#define _BYTECODE_HPP_
+
+// Include system libraries
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <cmath>
+#include <algorithm>
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// Include utility classes
+#include "IncrementalError.hpp"
+
+// Stack bytecode for arithmetic expressions
+// A program is a list of instructions in postfix order. Each instruction pushes a variable or
+// a constant, or replaces the values on top of the stack with the result of an operator.
+namespace Bytecode
+{
+    enum Opcode : std::uint8_t
+    {
+        PushVariable,
+        PushConstant,
+        Add,
+        Subtract,
+        Multiply,
+        Divide,
+        Power,
+        Minimum,
+        Maximum,
+        Negate,
+        Sin,
+        Cos,
+        Exp,
+        Log,
+        Sqrt,
+        Abs,
+        Tanh
+    };
+
+    struct Instruction
+    {
+        Opcode opcode;
+        std::uint32_t operand; // Variable or constant index
+    };
+
+    struct Program
+    {
+        std::vector<Instruction> code;
+        std::vector<float> constants;
+        unsigned int stackSize = 0; // Deepest the stack gets
+    };
+}
+
+// This class compiles the text of an expression phenotype into bytecode.
+// Expressions use the infix operators + - * / and ^, unary minus, brackets, numbers,
+// variables, and the functions sin cos exp log sqrt abs tanh min max and pow.
+// Only the declared operators may be used, so a phenotype using anything else fails to compile.
+// Operators whose operands are all constants are worked out while compiling.
+class BytecodeCompiler
+{
+public:
+    BytecodeCompiler();  // Default constructor
+    ~BytecodeCompiler(); // Destructor
+
+    // Set the names of the variables, which are numbered in order
+    void setVariables(const std::vector<std::string> &names);
+
+    // Set the operators that can be used, by symbol or function name, eg. "+", "neg", "sin"
+    // Every operator can be used until this is called
+    void setOperators(const std::vector<std::string> &names);
+
+    // Compile the expression, returning false if it isn't a valid expression
+    bool compile(const std::string &expression, Bytecode::Program &program);
+
+    // Get the names of every operator the compiler knows
+    static std::vector<std::string> getOperatorNames();
+
+    // Write the program as a C expression, reading variable i from columni[index]
+    // Minimum and maximum call grace_min and grace_max, which the surrounding code must define
+    static std::string toC(const Bytecode::Program &program, const std::string &index);
+
+private:
+    enum TokenType
+    {
+        Number,
+        Name,
+        Symbol,
+        End
+    };
+
+    // Work methods
+    void nextToken();
+    bool isSymbol(const char symbol) const;
+    bool parseExpression();
+    bool parseTerm();
+    bool parseUnary();
+    bool parsePower();
+    bool parsePrimary();
+    bool emit(const Bytecode::Opcode opcode);
+    void emitConstant(const float value);
+    bool isAllowed(const Bytecode::Opcode opcode) const;
+
+    // Private variables
+    std::unordered_map<std::string, std::uint32_t> variables;
+    std::vector<bool> allowed; // Indexed by opcode
+
+    // Parser state
+    const std::string *text;
+    std::size_t position;
+    TokenType tokenType;
+    std::string token;
+    float tokenValue;
+    Bytecode::Program *program;
+    unsigned int depth;
+};
+
+// This class runs bytecode over whole columns of data.
+// Rows are processed in blocks, running each instruction over every row of the block before
+// the next, so the cost of decoding an instruction is shared by the whole block. The arithmetic
+// operators use AVX-512 or AVX2 when the compiler targets them. A pushed variable points
+// straight at its column, so only results are written to the stack buffers.
+class BytecodeInterpreter
+{
+public:
+    static constexpr std::size_t blockSize = 256; // Rows in a block, a multiple of every vector width
+    static_assert(blockSize % IncrementalError::checkRows == 0, "Errors must be checked between blocks");
+
+    BytecodeInterpreter();  // Default constructor
+    ~BytecodeInterpreter(); // Destructor
+
+    // Run the program over rows [0, rowCount), calling block(values, begin, count) with the results of each block
+    // and stopping if it returns false. columns[i] points to the values of variable i
+    template <class BLOCK>
+    void run(const Bytecode::Program &program, const float *const *columns, const std::size_t rowCount, BLOCK block);
+
+    // Add up the squared differences between the results and the target in sum, which must be reset for rowCount rows
+    // Returns false if the sum stopped at its limit
+    bool sumSquaredError(const Bytecode::Program &program, const float *const *columns, const float *target, const std::size_t rowCount, IncrementalError &sum);
+
+    // Add up the absolute differences between the results and the target in the same way
+    bool sumAbsoluteError(const Bytecode::Program &program, const float *const *columns, const float *target, const std::size_t rowCount, IncrementalError &sum);
+
+private:
+    // Work methods
+    template <class ERROR>
+    bool sumError(const Bytecode::Program &program, const float *const *columns, const float *target, const std::size_t rowCount, IncrementalError &sum, ERROR error);
+    float *getBuffer(const unsigned int slot);
+    static void binary(const Bytecode::Opcode opcode, float *out, const float *a, const float *b);
+    static void unary(const Bytecode::Opcode opcode, float *out, const float *a);
+
+    // Private variables
+    std::vector<float> buffers;        // One block of values for each stack slot
+    std::vector<const float *> stack;  // Values of each stack slot for the current block
+};
+
+// Vector operations for the interpreter, on the widest vectors the compiler targets
+namespace BytecodeVector
+{
+#if defined(__AVX512F__)
+    using Vector = __m512;
+    constexpr std::size_t width = 16;
+    inline Vector load(const float *p) { return _mm512_loadu_ps(p); }
+    inline void store(float *p, Vector v) { _mm512_storeu_ps(p, v); }
+    inline Vector add(Vector a, Vector b) { return _mm512_add_ps(a, b); }
+    inline Vector subtract(Vector a, Vector b) { return _mm512_sub_ps(a, b); }
+    inline Vector multiply(Vector a, Vector b) { return _mm512_mul_ps(a, b); }
+    inline Vector divide(Vector a, Vector b) { return _mm512_div_ps(a, b); }
+    inline Vector minimum(Vector a, Vector b) { return _mm512_min_ps(a, b); }
+    inline Vector maximum(Vector a, Vector b) { return _mm512_max_ps(a, b); }
+#elif defined(__AVX2__)
+    using Vector = __m256;
+    constexpr std::size_t width = 8;
+    inline Vector load(const float *p) { return _mm256_loadu_ps(p); }
+    inline void store(float *p, Vector v) { _mm256_storeu_ps(p, v); }
+    inline Vector add(Vector a, Vector b) { return _mm256_add_ps(a, b); }
+    inline Vector subtract(Vector a, Vector b) { return _mm256_sub_ps(a, b); }
+    inline Vector multiply(Vector a, Vector b) { return _mm256_mul_ps(a, b); }
+    inline Vector divide(Vector a, Vector b) { return _mm256_div_ps(a, b); }
+    inline Vector minimum(Vector a, Vector b) { return _mm256_min_ps(a, b); }
+    inline Vector maximum(Vector a, Vector b) { return _mm256_max_ps(a, b); }
+#else
+    using Vector = float;
+    constexpr std::size_t width = 1;
+    inline Vector load(const float *p) { return *p; }
+    inline void store(float *p, Vector v) { *p = v; }
+    inline Vector add(Vector a, Vector b) { return a + b; }
+    inline Vector subtract(Vector a, Vector b) { return a - b; }
+    inline Vector multiply(Vector a, Vector b) { return a * b; }
+    inline Vector divide(Vector a, Vector b) { return a / b; }
+    inline Vector minimum(Vector a, Vector b) { return a < b ? a : b; }
+    inline Vector maximum(Vector a, Vector b) { return a > b ? a : b; }
+#endif
+
+    // Apply the operation to every value of a block
+    template <class OPERATION>
+    inline void apply(float *out, const float *a, const float *b, const std::size_t count, OPERATION operation)
+    {
+        for (std::size_t i = 0; i < count; i += width)
+        {
+            store(out + i, operation(load(a + i), load(b + i)));
+        }
+    }
+}
+
+// Default constructor
+inline BytecodeInterpreter::BytecodeInterpreter()
+{
+}
+
+// Destructor
+inline BytecodeInterpreter::~BytecodeInterpreter()
+{
+}
+
+template <class BLOCK>
+void BytecodeInterpreter::run(const Bytecode::Program &program, const float *const *columns, const std::size_t rowCount, BLOCK block)
+{
+    if (program.code.empty())
+    {
+        return;
+    }
+
+    if (buffers.size() < program.stackSize * blockSize)
+    {
+        buffers.resize(program.stackSize * blockSize);
+    }
+    stack.resize(program.stackSize);
+
+    for (std::size_t begin = 0; begin < rowCount; begin += blockSize)
+    {
+        std::size_t count = std::min(blockSize, rowCount - begin);
+        unsigned int top = 0; // Number of values on the stack
+
+        for (const Bytecode::Instruction &instruction : program.code)
+        {
+            switch (instruction.opcode)
+            {
+            case Bytecode::PushVariable:
+                // The last block is copied, so the operators can always work on whole blocks
+                if (count == blockSize)
+                {
+                    stack[top] = columns[instruction.operand] + begin;
+                }
+                else
+                {
+                    float *buffer = getBuffer(top);
+                    std::copy(columns[instruction.operand] + begin, columns[instruction.operand] + begin + count, buffer);
+                    std::fill(buffer + count, buffer + blockSize, 0.0f);
+                    stack[top] = buffer;
+                }
+                ++top;
+                break;
+
+            case Bytecode::PushConstant:
+            {
+                float *buffer = getBuffer(top);
+                std::fill(buffer, buffer + blockSize, program.constants[instruction.operand]);
+                stack[top] = buffer;
+                ++top;
+                break;
+            }
+
+            case Bytecode::Add:
+            case Bytecode::Subtract:
+            case Bytecode::Multiply:
+            case Bytecode::Divide:
+            case Bytecode::Power:
+            case Bytecode::Minimum:
+            case Bytecode::Maximum:
+            {
+                float *buffer = getBuffer(top - 2);
+                binary(instruction.opcode, buffer, stack[top - 2], stack[top - 1]);
+                stack[top - 2] = buffer;
+                --top;
+                break;
+            }
+
+            default:
+            {
+                float *buffer = getBuffer(top - 1);
+                unary(instruction.opcode, buffer, stack[top - 1]);
+                stack[top - 1] = buffer;
+                break;
+            }
+            }
+        }
+
+        if (!block(stack[0], begin, count))
+        {
+            return;
+        }
+    }
+}
+
+inline bool BytecodeInterpreter::sumSquaredError(const Bytecode::Program &program, const float *const *columns, const float *target, const std::size_t rowCount, IncrementalError &sum)
+{
+    return sumError(program, columns, target, rowCount, sum, [](float difference)
+                    { return difference * difference; });
+}
+
+inline bool BytecodeInterpreter::sumAbsoluteError(const Bytecode::Program &program, const float *const *columns, const float *target, const std::size_t rowCount, IncrementalError &sum)
+{
+    return sumError(program, columns, target, rowCount, sum, [](float difference)
+                    { return std::fabs(difference); });
+}
+
+// Each block is added to the sum as soon as it has run, so a sum past its limit stops the program
+template <class ERROR>
+bool BytecodeInterpreter::sumError(const Bytecode::Program &program, const float *const *columns, const float *target, const std::size_t rowCount, IncrementalError &sum, ERROR error)
+{
+    run(program, columns, rowCount, [&](const float *values, std::size_t begin, std::size_t count)
+        { return sum.add(values, target + begin, count, error); });
+    return !sum.isStopped();
+}
+
+inline float *BytecodeInterpreter::getBuffer(const unsigned int slot)
+{
+    return buffers.data() + slot * blockSize;
+}
+
+inline void BytecodeInterpreter::binary(const Bytecode::Opcode opcode, float *out, const float *a, const float *b)
+{
+    using namespace BytecodeVector;
+
+    switch (opcode)
+    {
+    case Bytecode::Add:
+        apply(out, a, b, blockSize, [](Vector x, Vector y)
+              { return add(x, y); });
+        break;
+    case Bytecode::Subtract:
+        apply(out, a, b, blockSize, [](Vector x, Vector y)
+              { return subtract(x, y); });
+        break;
+    case Bytecode::Multiply:
+        apply(out, a, b, blockSize, [](Vector x, Vector y)
+              { return multiply(x, y); });
+        break;
+    case Bytecode::Divide:
+        apply(out, a, b, blockSize, [](Vector x, Vector y)
+              { return divide(x, y); });
+        break;
+    case Bytecode::Minimum:
+        apply(out, a, b, blockSize, [](Vector x, Vector y)
+              { return minimum(x, y); });
+        break;
+    case Bytecode::Maximum:
+        apply(out, a, b, blockSize, [](Vector x, Vector y)
+              { return maximum(x, y); });
+        break;
+    default:
+        for (std::size_t i = 0; i < blockSize; ++i)
+        {
+            out[i] = std::pow(a[i], b[i]);
+        }
+        break;
+    }
+}
+
+inline void BytecodeInterpreter::unary(const Bytecode::Opcode opcode, float *out, const float *a)
+{
+    switch (opcode)
+    {
+    case Bytecode::Negate:
+        for (std::size_t i = 0; i < blockSize; ++i)
+        {
+            out[i] = -a[i];
+        }
+        break;
+    case Bytecode::Sin:
+        for (std::size_t i = 0; i < blockSize; ++i)
+        {
+            out[i] = std::sin(a[i]);
+        }
+        break;
+    case Bytecode::Cos:
+        for (std::size_t i = 0; i < blockSize; ++i)
+        {
+            out[i] = std::cos(a[i]);
+        }
+        break;
+    case Bytecode::Exp:
+        for (std::size_t i = 0; i < blockSize; ++i)
+        {
+            out[i] = std::exp(a[i]);
+        }
+        break;
+    case Bytecode::Log:
+        for (std::size_t i = 0; i < blockSize; ++i)
+        {
+            out[i] = std::log(a[i]);
+        }
+        break;
+    case Bytecode::Sqrt:
+        for (std::size_t i = 0; i < blockSize; ++i)
+        {
+            out[i] = std::sqrt(a[i]);
+        }
+        break;
+    case Bytecode::Abs:
+        for (std::size_t i = 0; i < blockSize; ++i)
+        {
+            out[i] = std::fabs(a[i]);
+        }
+        break;
+    default:
+        for (std::size_t i = 0; i < blockSize; ++i)
+        {
+            out[i] = std::tanh(a[i]);
+        }
+        break;
+    }
+}
+
+#endif
@@ -0,0 +1,381 @@
+#ifndef _COLUMNARDATASET_CPP_
+#define _COLUMNARDATASET_CPP_
+
+#include "ColumnarDataset.hpp"
+
+// Include system libraries
+#include <map>
+#include <mutex>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Datasets open in this process by binary file, so runs in one process share a mapping
+static std::mutex registryMutex;
+static std::map<std::string, std::weak_ptr<const ColumnarDataset>> registry;
+
+// Get the size and modification time of a file, returning false if it doesn't exist
+static bool getFileStatus(const std::string &path, std::uint64_t &size, std::int64_t &modified)
+{
+    struct stat status;
+    if (stat(path.c_str(), &status) != 0)
+    {
+        return false;
+    }
+
+    size = status.st_size;
+    modified = static_cast<std::int64_t>(status.st_mtim.tv_sec) * 1000000000 + status.st_mtim.tv_nsec;
+    return true;
+}
+
+// Write all of a buffer, returning false if the file can't take it
+static bool writeAll(const int file, const void *data, std::size_t size)
+{
+    const char *position = static_cast<const char *>(data);
+    while (size > 0)
+    {
+        ssize_t written = write(file, position, size);
+        if (written <= 0)
+        {
+            return false;
+        }
+        position += written;
+        size -= written;
+    }
+    return true;
+}
+
+// Default constructor
+ColumnarDataset::ColumnarDataset() : mapping(nullptr),
+                                     mappingSize(0)
+{
+}
+
+// Destructor
+ColumnarDataset::~ColumnarDataset()
+{
+    if (mapping)
+    {
+        munmap(mapping, mappingSize);
+    }
+}
+
+// Use the dataset another run in this process has open if it is still up to date, then the binary file,
+// converting the CSV file again if the binary file was made from a different version of it
+std::shared_ptr<const ColumnarDataset> ColumnarDataset::open(const std::string &csvPath, const std::string &binaryPath)
+{
+    std::string path = binaryPath.empty() ? csvPath + ".columns" : binaryPath;
+
+    std::uint64_t csvSize = 0;
+    std::int64_t csvModified = 0;
+    bool hasCsv = getFileStatus(csvPath, csvSize, csvModified);
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+
+    // Files are registered by their full path, so different names for one file share it
+    char fullPath[PATH_MAX];
+    std::string key = realpath(path.c_str(), fullPath) ? fullPath : path;
+    auto found = registry.find(key);
+    if (found != registry.end())
+    {
+        std::shared_ptr<const ColumnarDataset> dataset = found->second.lock();
+        if (dataset && (!hasCsv || dataset->isFrom(csvSize, csvModified)))
+        {
+            return dataset;
+        }
+    }
+
+    std::shared_ptr<ColumnarDataset> dataset(new ColumnarDataset());
+    if (!dataset->map(path) || (hasCsv && !dataset->isFrom(csvSize, csvModified)))
+    {
+        dataset.reset(new ColumnarDataset());
+        if (!hasCsv || !convert(csvPath, path) || !dataset->map(path))
+        {
+            return nullptr;
+        }
+    }
+
+    key = realpath(path.c_str(), fullPath) ? fullPath : path;
+    registry[key] = dataset;
+    return dataset;
+}
+
+// The CSV file is read into memory, then written a column at a time to a temporary file that replaces the binary file
+bool ColumnarDataset::convert(const std::string &csvPath, const std::string &binaryPath)
+{
+    std::uint64_t csvSize = 0;
+    std::int64_t csvModified = 0;
+    std::ifstream csv(csvPath);
+    if (!csv || !getFileStatus(csvPath, csvSize, csvModified))
+    {
+        return false;
+    }
+
+    // Read the column names
+    std::vector<std::string> names;
+    std::string line;
+    if (std::getline(csv, line))
+    {
+        std::istringstream stream(line);
+        std::string name;
+        while (std::getline(stream, name, ','))
+        {
+            // Trim spaces and a carriage return
+            std::size_t first = name.find_first_not_of(" \t\r");
+            std::size_t last = name.find_last_not_of(" \t\r");
+            names.push_back(first == std::string::npos ? "" : name.substr(first, last - first + 1));
+        }
+    }
+
+    if (names.empty())
+    {
+        return false;
+    }
+
+    // Read the rows, skipping blank lines
+    std::vector<std::vector<float>> values(names.size());
+    while (std::getline(csv, line))
+    {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+        {
+            continue;
+        }
+
+        const char *position = line.c_str();
+        for (std::size_t column = 0; column < names.size(); ++column)
+        {
+            char *end;
+            values[column].push_back(std::strtof(position, &end));
+            if (end == position || (column + 1 < names.size() && *end != ','))
+            {
+                return false;
+            }
+            position = end + 1;
+        }
+    }
+
+    Header header = {};
+    header.magic = fileMagic;
+    header.version = fileVersion;
+    header.columnCount = names.size();
+    header.rowCount = values[0].size();
+    header.paddedRows = (header.rowCount + alignmentRows - 1) / alignmentRows * alignmentRows;
+    header.csvSize = csvSize;
+    header.csvModified = csvModified;
+
+    std::string nameData;
+    for (const std::string &name : names)
+    {
+        nameData += name;
+        nameData += '\0';
+    }
+    header.namesSize = nameData.size();
+
+    // Write everything to a temporary file next to the binary file
+    std::string temporaryPath = binaryPath + ".XXXXXX";
+    std::vector<char> pathBuffer(temporaryPath.begin(), temporaryPath.end());
+    pathBuffer.push_back('\0');
+    int file = mkstemp(pathBuffer.data());
+    if (file < 0)
+    {
+        return false;
+    }
+
+    std::vector<char> padding(getDataOffset(header.namesSize) - sizeof(Header) - header.namesSize, 0);
+    bool isWritten = writeAll(file, &header, sizeof(Header)) &&
+                     writeAll(file, nameData.data(), nameData.size()) &&
+                     writeAll(file, padding.data(), padding.size());
+
+    std::vector<float> columnPadding(header.paddedRows - header.rowCount, 0.0f);
+    for (std::size_t column = 0; column < values.size() && isWritten; ++column)
+    {
+        isWritten = writeAll(file, values[column].data(), values[column].size() * sizeof(float)) &&
+                    writeAll(file, columnPadding.data(), columnPadding.size() * sizeof(float));
+    }
+
+    // Readers only ever see a whole file
+    fchmod(file, 0644);
+    isWritten = close(file) == 0 && isWritten && rename(pathBuffer.data(), binaryPath.c_str()) == 0;
+    if (!isWritten)
+    {
+        unlink(pathBuffer.data());
+    }
+    return isWritten;
+}
+
+// Get methods
+std::size_t ColumnarDataset::getRowCount() const
+{
+    return static_cast<const Header *>(mapping)->rowCount;
+}
+
+std::size_t ColumnarDataset::getColumnCount() const
+{
+    return columns.size();
+}
+
+const std::vector<std::string> &ColumnarDataset::getNames() const
+{
+    return names;
+}
+
+std::size_t ColumnarDataset::getColumnIndex(const std::string &name) const
+{
+    return std::find(names.begin(), names.end(), name) - names.begin();
+}
+
+ColumnarDataset::ColumnSpan ColumnarDataset::getColumn(const std::size_t column) const
+{
+    return {columns[column], getRowCount()};
+}
+
+ColumnarDataset::View ColumnarDataset::getView() const
+{
+    return View(shared_from_this(), 0, getRowCount());
+}
+
+// Map the binary file, checking that it is a whole dataset
+bool ColumnarDataset::map(const std::string &path)
+{
+    int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(file, &status) == 0 && static_cast<std::size_t>(status.st_size) >= sizeof(Header))
+    {
+        mapping = mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, file, 0);
+        mappingSize = status.st_size;
+    }
+
+    // The mapping stays valid once the file is closed
+    ::close(file);
+
+    if (mapping == MAP_FAILED || mapping == nullptr)
+    {
+        mapping = nullptr;
+        mappingSize = 0;
+        return false;
+    }
+
+    const Header *header = static_cast<const Header *>(mapping);
+    bool isValid = header->magic == fileMagic && header->version == fileVersion &&
+                   header->columnCount > 0 && header->paddedRows % alignmentRows == 0 && header->paddedRows >= header->rowCount &&
+                   getDataOffset(header->namesSize) + header->columnCount * header->paddedRows * sizeof(float) == mappingSize;
+
+    // Read the names, which must be one for each column
+    const char *nameData = static_cast<const char *>(mapping) + sizeof(Header);
+    names.clear();
+    for (std::size_t position = 0; isValid && position < header->namesSize;)
+    {
+        const char *end = static_cast<const char *>(std::memchr(nameData + position, '\0', header->namesSize - position));
+        isValid = end != nullptr;
+        if (isValid)
+        {
+            names.emplace_back(nameData + position, end);
+            position = end - nameData + 1;
+        }
+    }
+    isValid = isValid && names.size() == header->columnCount;
+
+    if (!isValid)
+    {
+        munmap(mapping, mappingSize);
+        mapping = nullptr;
+        mappingSize = 0;
+        names.clear();
+        return false;
+    }
+
+    const float *data = reinterpret_cast<const float *>(static_cast<const char *>(mapping) + getDataOffset(header->namesSize));
+    columns.clear();
+    for (std::size_t column = 0; column < header->columnCount; ++column)
+    {
+        columns.push_back(data + column * header->paddedRows);
+    }
+    return true;
+}
+
+bool ColumnarDataset::isFrom(const std::uint64_t csvSize, const std::int64_t csvModified) const
+{
+    const Header *header = static_cast<const Header *>(mapping);
+    return header->csvSize == csvSize && header->csvModified == csvModified;
+}
+
+// The columns start after the header and names, on an alignment boundary
+std::size_t ColumnarDataset::getDataOffset(const std::size_t namesSize)
+{
+    return (sizeof(Header) + namesSize + alignment - 1) / alignment * alignment;
+}
+
+// Default constructor
+ColumnarDataset::View::View() : rowBegin(0),
+                                rowCount(0)
+{
+}
+
+ColumnarDataset::View::View(std::shared_ptr<const ColumnarDataset> dataset, const std::size_t rowBegin, const std::size_t rowCount)
+    : dataset(std::move(dataset)),
+      rowBegin(rowBegin),
+      rowCount(rowCount)
+{
+}
+
+ColumnarDataset::View ColumnarDataset::View::slice(const std::size_t begin, const std::size_t count) const
+{
+    std::size_t first = std::min(begin, rowCount);
+    return View(dataset, rowBegin + first, std::min(count, rowCount - first));
+}
+
+void ColumnarDataset::View::split(const double validationRate, View &training, View &validation) const
+{
+    std::size_t trainingRows = static_cast<std::size_t>(rowCount * (1.0 - validationRate));
+    if (trainingRows < rowCount && trainingRows >= alignmentRows)
+    {
+        trainingRows -= trainingRows % alignmentRows;
+    }
+    training = slice(0, trainingRows);
+    validation = slice(trainingRows, rowCount - trainingRows);
+}
+
+ColumnarDataset::ColumnSpan ColumnarDataset::View::getColumn(const std::size_t column) const
+{
+    return {dataset->columns[column] + rowBegin, rowCount};
+}
+
+std::size_t ColumnarDataset::View::getColumnCount() const
+{
+    return dataset ? dataset->getColumnCount() : 0;
+}
+
+std::size_t ColumnarDataset::View::getRowCount() const
+{
+    return rowCount;
+}
+
+std::size_t ColumnarDataset::View::getRowBegin() const
+{
+    return rowBegin;
+}
+
+bool ColumnarDataset::View::isAligned() const
+{
+    return rowBegin % alignmentRows == 0;
+}
+
+const ColumnarDataset *ColumnarDataset::View::getDataset() const
+{
+    return dataset.get();
+}
+
+#endif
@@ -0,0 +1,115 @@
+#ifndef _COLUMNARDATASET_HPP_
+#define _COLUMNARDATASET_HPP_
+
+// Include system libraries
+#include <string>
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+// This class keeps a dataset's columns in a binary file that is memory-mapped read-only.
+// A CSV file with a header of column names is converted once into a binary file, which is used from then on
+// until the CSV file changes. Each column is stored as floats starting on a 64 byte boundary and padded with zeros
+// to a whole number of alignment rows, so columns can be read with aligned vector loads and whole vectors past the
+// last row are safe to read. Datasets opened from the same binary file in one process share one mapping, which
+// stays mapped while any dataset or view uses it. The file is in the byte order of the machine that wrote it.
+class ColumnarDataset : public std::enable_shared_from_this<ColumnarDataset>
+{
+public:
+    static constexpr std::size_t alignment = 64;                           // Bytes each column is aligned to
+    static constexpr std::size_t alignmentRows = alignment / sizeof(float); // Rows in one alignment
+
+    // Values of one column over consecutive rows
+    struct ColumnSpan
+    {
+        const float *data;
+        std::size_t size;
+
+        const float *begin() const { return data; }
+        const float *end() const { return data + size; }
+        const float &operator[](const std::size_t row) const { return data[row]; }
+    };
+
+    // Consecutive rows of a dataset, which are never copied
+    // A view keeps its dataset mapped, so it can outlive the dataset it came from
+    class View
+    {
+    public:
+        View(); // Default constructor, with no rows
+        View(std::shared_ptr<const ColumnarDataset> dataset, const std::size_t rowBegin, const std::size_t rowCount);
+
+        // Get the rows [begin, begin + count) of the view
+        View slice(const std::size_t begin, const std::size_t count) const;
+
+        // Split the view into training rows and the validation rows after them
+        // The training rows are rounded down to whole alignment rows, so both views stay aligned if this one is,
+        // unless that would leave no training rows
+        void split(const double validationRate, View &training, View &validation) const;
+
+        // Get methods
+        ColumnSpan getColumn(const std::size_t column) const;
+        std::size_t getColumnCount() const;
+        std::size_t getRowCount() const;
+        std::size_t getRowBegin() const;   // Position of the first row in the dataset
+        bool isAligned() const;            // Whether every column of the view starts on an alignment boundary
+        const ColumnarDataset *getDataset() const;
+
+    private:
+        std::shared_ptr<const ColumnarDataset> dataset;
+        std::size_t rowBegin;
+        std::size_t rowCount;
+    };
+
+    ColumnarDataset(const ColumnarDataset &) = delete; // The mapping can't be copied
+    ColumnarDataset &operator=(const ColumnarDataset &) = delete;
+    ~ColumnarDataset(); // Destructor
+
+    // Open the dataset of a CSV file, converting it first if its binary file is missing or out of date
+    // The binary file is the CSV file's path with ".columns" added, unless another path is given
+    // Returns nullptr if the CSV file isn't a valid dataset, or neither file can be used
+    static std::shared_ptr<const ColumnarDataset> open(const std::string &csvPath, const std::string &binaryPath = "");
+
+    // Convert a CSV file into a binary file, returning false if it isn't a valid dataset or can't be written
+    // The binary file is replaced in one step, so processes reading the old file are unaffected
+    static bool convert(const std::string &csvPath, const std::string &binaryPath);
+
+    // Get methods
+    std::size_t getRowCount() const;
+    std::size_t getColumnCount() const;
+    const std::vector<std::string> &getNames() const;
+    std::size_t getColumnIndex(const std::string &name) const; // The column count if no column has the name
+    ColumnSpan getColumn(const std::size_t column) const;
+    View getView() const; // Every row of the dataset
+
+private:
+    struct Header
+    {
+        std::uint64_t magic;
+        std::uint64_t version;
+        std::uint64_t columnCount;
+        std::uint64_t rowCount;
+        std::uint64_t paddedRows;  // Rows stored for each column, a multiple of alignmentRows
+        std::uint64_t namesSize;   // Bytes of column names, each ending in a zero
+        std::uint64_t csvSize;     // Size of the CSV file it was converted from
+        std::int64_t csvModified;  // Modification time of the CSV file in nanoseconds
+    };
+
+    ColumnarDataset(); // Only made by open
+
+    // Work methods
+    bool map(const std::string &path);
+    bool isFrom(const std::uint64_t csvSize, const std::int64_t csvModified) const;
+    static std::size_t getDataOffset(const std::size_t namesSize);
+
+    // Private variables
+    static constexpr std::uint64_t fileMagic = 0x4c4f434543415247ULL; // "GRACECOL" - Marks a columnar dataset file
+    static constexpr std::uint64_t fileVersion = 1;
+
+    void *mapping;
+    std::size_t mappingSize;
+    std::vector<std::string> names;
+    std::vector<const float *> columns;
+};
+
+#endif
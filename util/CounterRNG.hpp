@@ -0,0 +1,79 @@
+#ifndef _COUNTERRNG_HPP_
+#define _COUNTERRNG_HPP_
+
+// Include system libraries
+#include <cstdint>
+#include <limits>
+
+// This class implements a counter-based random number engine, derived from SplitMix64.
+// The n-th number of a stream is a hash of the stream's key and n, so every stream can be
+// worked out on its own without stepping any other engine. A stream is keyed by a seed, the
+// generation, an individual's index and a stream number, which lets operators give each
+// individual its own numbers whatever order, or thread, the individuals are processed in.
+// It meets the UniformRandomBitGenerator requirements, so it works with the standard distributions.
+class CounterRNG
+{
+public:
+    using result_type = std::uint64_t;
+
+    CounterRNG(const std::uint64_t seed = 0, const std::uint64_t generation = 0, const std::uint64_t index = 0, const std::uint64_t stream = 0); // Default constructor
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    result_type operator()();
+
+    // Skip the next count numbers
+    void discard(const std::uint64_t count);
+
+    // Get the n-th number of the stream without changing the engine
+    result_type at(const std::uint64_t counter) const;
+
+    // Comparison operators, as for the standard engines
+    bool operator==(const CounterRNG &other) const { return key == other.key && counter == other.counter; }
+    bool operator!=(const CounterRNG &other) const { return !(*this == other); }
+
+private:
+    // SplitMix64's output function
+    static std::uint64_t mix(std::uint64_t z);
+
+    static constexpr std::uint64_t golden = 0x9E3779B97F4A7C15ULL;
+
+    std::uint64_t key;
+    std::uint64_t counter;
+};
+
+// Default constructor
+// Each part of the key is mixed in turn, so keys that differ in any part give unrelated streams
+inline CounterRNG::CounterRNG(const std::uint64_t seed, const std::uint64_t generation, const std::uint64_t index, const std::uint64_t stream)
+    : counter(0)
+{
+    key = mix(seed + golden);
+    key = mix(key ^ (generation + golden));
+    key = mix(key ^ (index + golden));
+    key = mix(key ^ (stream + golden));
+}
+
+inline CounterRNG::result_type CounterRNG::operator()()
+{
+    return at(counter++);
+}
+
+inline void CounterRNG::discard(const std::uint64_t count)
+{
+    counter += count;
+}
+
+inline CounterRNG::result_type CounterRNG::at(const std::uint64_t counter) const
+{
+    return mix(key + (counter + 1) * golden);
+}
+
+inline std::uint64_t CounterRNG::mix(std::uint64_t z)
+{
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+#endif
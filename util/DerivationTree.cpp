@@ -3,6 +3,9 @@
 
 #include "DerivationTree.hpp"
 
+// Buffers looked at for one big enough, so small ones aren't thrown away
+static constexpr std::size_t searchSize = 8;
+
 // Default constructor
 DerivationTree::DerivationTree(const unsigned int newDepth, const unsigned int newCurrentLevel) : depth(newDepth),
                                                                                                   currentLevel(newCurrentLevel)
@@ -24,11 +27,39 @@ DerivationTree::DerivationTree(const DerivationTree &copy) : children(copy.getCh
 {
 }
 
+// Move constructor
+DerivationTree::DerivationTree(DerivationTree &&other) noexcept : children(std::move(other.children)),
+                                                                 data(std::move(other.data)),
+                                                                 depth(other.depth),
+                                                                 currentLevel(other.currentLevel)
+{
+}
+
 // Destructor
 DerivationTree::~DerivationTree()
 {
 }
 
+// Copy assignment
+DerivationTree &DerivationTree::operator=(const DerivationTree &copy)
+{
+    this->children = copy.children;
+    this->data = copy.data;
+    this->depth = copy.depth;
+    this->currentLevel = copy.currentLevel;
+    return *this;
+}
+
+// Move assignment
+DerivationTree &DerivationTree::operator=(DerivationTree &&other) noexcept
+{
+    this->children = std::move(other.children);
+    this->data = std::move(other.data);
+    this->depth = other.depth;
+    this->currentLevel = other.currentLevel;
+    return *this;
+}
+
 // Get/Set methods
 unsigned int DerivationTree::getDepth() const
 {
@@ -70,6 +101,58 @@ void DerivationTree::setData(const DerivationTree::SymbolPointer &newData)
     this->data = newData;
 }
 
+void DerivationTree::reserveChildren(const std::size_t count, ChildrenBuffers &buffers)
+{
+    if (children.capacity() == 0 && !buffers.empty())
+    {
+        // Look at the last few buffers for one that is big enough
+        std::size_t index = buffers.size() - 1;
+        for (std::size_t look = 1; look < searchSize && look < buffers.size() && buffers[index].capacity() < count; ++look)
+        {
+            index = buffers.size() - 1 - look;
+        }
+        children.swap(buffers[index]);
+        buffers[index].swap(buffers.back());
+        buffers.pop_back();
+    }
+    children.reserve(count);
+}
+
+void DerivationTree::reset()
+{
+    children.clear();
+    data.reset();
+    depth = 1;
+    currentLevel = 1;
+}
+
+void DerivationTree::reset(ChildrenBuffers &buffers)
+{
+    for (DerivationTree &child : children)
+    {
+        child.releaseChildren(buffers);
+    }
+    reset();
+}
+
+// Move the children buffers of this node and the nodes below it into buffers
+void DerivationTree::releaseChildren(ChildrenBuffers &buffers)
+{
+    if (children.capacity() == 0)
+    {
+        return;
+    }
+
+    for (DerivationTree &child : children)
+    {
+        child.releaseChildren(buffers);
+    }
+
+    children.clear();
+    buffers.emplace_back();
+    buffers.back().swap(children);
+}
+
 // Print derivation tree to screen
 void DerivationTree::printTree()
 {
@@ -4,6 +4,7 @@
 // Include system libraries
 #include <vector>
 #include <memory>
+#include <cstddef>
 
 // Include member headers
 #include "../grammar/Symbol.hpp"
@@ -14,11 +15,17 @@ public:
     // Define new types to help readability
     using SymbolPointer = std::shared_ptr<Symbol>;
     using Children = std::vector<DerivationTree>;
+    using ChildrenBuffers = std::vector<Children>; // Empty children buffers kept for new nodes
 
     DerivationTree(const unsigned int = 1, const unsigned int = 1); // Default constructor
     DerivationTree(const SymbolPointer &, const unsigned int = 1, const unsigned int = 1); // Constructor with Symbol
     DerivationTree(const DerivationTree &); // Copy constructor
+    DerivationTree(DerivationTree &&) noexcept; // Move constructor
     ~DerivationTree(); // Destructor
+
+    // Assignment operators
+    DerivationTree &operator=(const DerivationTree &);
+    DerivationTree &operator=(DerivationTree &&) noexcept;
     
     // Get/Set methods
     unsigned int getDepth() const;
@@ -30,6 +37,14 @@ public:
     const Children getChildren() const;
     void setChildren(const Children);
 
+    // Reserve room for children, taking a buffer from buffers if the node has none
+    void reserveChildren(const std::size_t, ChildrenBuffers &);
+
+    // Return the tree to a single node with no symbol, keeping its children buffer for reuse
+    // The second version also keeps the buffers of the nodes below, moving them into buffers
+    void reset();
+    void reset(ChildrenBuffers &);
+
     // Print derivation tree to screen
     void printTree();
 
@@ -37,6 +52,9 @@ public:
     Children children;
 
 private:
+    // Work methods
+    void releaseChildren(ChildrenBuffers &);
+
     // Private variables
     SymbolPointer data;
     unsigned int depth; // Track the maximum depth of this path
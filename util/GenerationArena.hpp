@@ -0,0 +1,156 @@
+#ifndef _GENERATIONARENA_HPP_
+#define _GENERATIONARENA_HPP_
+
+// Include system libraries
+#include <vector>
+#include <cstddef>
+#include <memory_resource>
+
+// This class implements a monotonic memory resource that is reset after every generation.
+// Deallocation is a no-op; reset() rewinds the arena and, if the generation needed more than
+// one chunk, replaces them with a single chunk large enough for the whole generation.
+// After the first few generations, allocations from the arena never reach the upstream resource.
+class GenerationArena : public std::pmr::memory_resource
+{
+public:
+    GenerationArena(const std::size_t initialSize = 64 * 1024, // Default constructor
+                    std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+    GenerationArena(const GenerationArena &) = delete; // The arena owns its chunks
+    GenerationArena &operator=(const GenerationArena &) = delete;
+    ~GenerationArena() override; // Destructor
+
+    // Release everything allocated since the last reset
+    void reset();
+
+    // Get methods
+    std::size_t getCapacity() const;
+    std::size_t getUsed() const;
+
+protected:
+    // Implement pure virtual methods from std::pmr::memory_resource
+    void *do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void *, std::size_t, std::size_t) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+private:
+    struct Chunk
+    {
+        std::byte *data;
+        std::size_t size;
+    };
+
+    // Work methods
+    void addChunk(const std::size_t minimumSize);
+    void releaseChunks();
+
+    // Private variables
+    std::pmr::memory_resource *upstream;
+    std::vector<Chunk> chunks;
+    std::size_t currentChunk;
+    std::size_t offset;
+    std::size_t used; // Bytes handed out since the last reset
+};
+
+// Default constructor
+inline GenerationArena::GenerationArena(const std::size_t initialSize, std::pmr::memory_resource *upstream)
+    : upstream(upstream),
+      currentChunk(0),
+      offset(0),
+      used(0)
+{
+    addChunk(initialSize);
+}
+
+// Destructor
+inline GenerationArena::~GenerationArena()
+{
+    releaseChunks();
+}
+
+// Rewind the arena, merging the chunks used in this generation into one
+inline void GenerationArena::reset()
+{
+    if (chunks.size() > 1)
+    {
+        std::size_t capacity = getCapacity();
+        releaseChunks();
+        addChunk(capacity);
+    }
+
+    currentChunk = 0;
+    offset = 0;
+    used = 0;
+}
+
+// Get methods
+inline std::size_t GenerationArena::getCapacity() const
+{
+    std::size_t capacity = 0;
+    for (const Chunk &chunk : chunks)
+    {
+        capacity += chunk.size;
+    }
+    return capacity;
+}
+
+inline std::size_t GenerationArena::getUsed() const
+{
+    return used;
+}
+
+// Bump allocate from the current chunk, moving to a new chunk when it is full
+inline void *GenerationArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    while (true)
+    {
+        Chunk &chunk = chunks[currentChunk];
+
+        // Align the offset in the current chunk
+        std::size_t address = reinterpret_cast<std::size_t>(chunk.data) + offset;
+        std::size_t padding = (alignment - (address % alignment)) % alignment;
+
+        if (offset + padding + bytes <= chunk.size)
+        {
+            void *pointer = chunk.data + offset + padding;
+            offset += padding + bytes;
+            used += padding + bytes;
+            return pointer;
+        }
+
+        // Move onto the next chunk, creating it if needed
+        if (currentChunk + 1 == chunks.size())
+        {
+            addChunk(bytes + alignment);
+        }
+        ++currentChunk;
+        offset = 0;
+    }
+}
+
+// Memory is only released when the arena is reset
+inline void GenerationArena::do_deallocate(void *, std::size_t, std::size_t)
+{
+}
+
+inline bool GenerationArena::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+// Add a chunk that is at least double the size of the last one
+inline void GenerationArena::addChunk(const std::size_t minimumSize)
+{
+    std::size_t size = chunks.empty() ? minimumSize : std::max(minimumSize, chunks.back().size * 2);
+    chunks.push_back({static_cast<std::byte *>(upstream->allocate(size, alignof(std::max_align_t))), size});
+}
+
+inline void GenerationArena::releaseChunks()
+{
+    for (const Chunk &chunk : chunks)
+    {
+        upstream->deallocate(chunk.data, chunk.size, alignof(std::max_align_t));
+    }
+    chunks.clear();
+}
+
+#endif
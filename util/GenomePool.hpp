@@ -0,0 +1,103 @@
+#ifndef _GENOMEPOOL_HPP_
+#define _GENOMEPOOL_HPP_
+
+// Include system libraries
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstddef>
+
+// This template class recycles genomes between generations.
+// The pool keeps a reference to every genome it has created. A genome whose only
+// reference is the pool's is free, and is reset and handed out again by acquire().
+// Recycled genomes keep the capacity of their buffers, so in steady state creating
+// a child does not allocate. Anything else with a reset() method, such as a derivation tree, can be
+// recycled the same way, and acquire() passes its arguments on to reset().
+template <class GENOMETYPE>
+class GenomePool
+{
+public:
+    // Define new types to help readability
+    using GenomePointer = std::shared_ptr<GENOMETYPE>;
+
+    GenomePool();  // Default constructor
+    ~GenomePool(); // Destructor
+
+    // Get a reset genome, recycling a free one if possible
+    template <class... ARGUMENTS>
+    GenomePointer acquire(ARGUMENTS &...arguments);
+
+    // Get methods
+    std::size_t size() const;
+
+private:
+    // Work methods
+    void sweep();
+
+    // Private variables
+    std::vector<GenomePointer> genomes;     // Every genome created by the pool
+    std::vector<std::size_t> freeGenomes;   // Indices of the genomes found free by the last sweep
+};
+
+// Default constructor
+template <class GENOMETYPE>
+GenomePool<GENOMETYPE>::GenomePool()
+{
+}
+
+// Destructor
+template <class GENOMETYPE>
+GenomePool<GENOMETYPE>::~GenomePool()
+{
+}
+
+// Hand out a free genome
+template <class GENOMETYPE>
+template <class... ARGUMENTS>
+typename GenomePool<GENOMETYPE>::GenomePointer GenomePool<GENOMETYPE>::acquire(ARGUMENTS &...arguments)
+{
+    // Look for free genomes once the previous ones have been used
+    if (freeGenomes.empty())
+    {
+        sweep();
+    }
+
+    // Take the genome from the back of the free list
+    const GenomePointer &genome = genomes[freeGenomes.back()];
+    freeGenomes.pop_back();
+    genome->reset(arguments...);
+
+    return genome;
+}
+
+template <class GENOMETYPE>
+std::size_t GenomePool<GENOMETYPE>::size() const
+{
+    return genomes.size();
+}
+
+// Collect the genomes that are only referenced by the pool, growing the pool if too few are free
+template <class GENOMETYPE>
+void GenomePool<GENOMETYPE>::sweep()
+{
+    for (std::size_t index = 0; index < genomes.size(); ++index)
+    {
+        if (genomes[index].use_count() == 1)
+        {
+            freeGenomes.push_back(index);
+        }
+    }
+
+    // Grow geometrically so that sweeps stay amortised O(1) per genome
+    if (freeGenomes.size() < genomes.size() / 4 + 1)
+    {
+        std::size_t growth = std::max<std::size_t>(16, genomes.size() / 2);
+        for (std::size_t i = 0; i < growth; ++i)
+        {
+            freeGenomes.push_back(genomes.size());
+            genomes.push_back(std::make_shared<GENOMETYPE>());
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,248 @@
+#ifndef _GENOTYPE_HPP_
+#define _GENOTYPE_HPP_
+
+// Include system libraries
+#include <vector>
+#include <memory>
+#include <initializer_list>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+
+// This class implements a copy-on-write codon buffer.
+// Copies share the same codons until one of them is modified,
+// so cloning a genome costs O(1) until one of the copies changes.
+// A buffer that is replaced by shared codons while nothing else uses it is kept as a spare,
+// and the next copy on write reuses it, so recycled genotypes don't allocate.
+class Genotype
+{
+public:
+    // Define new types to help readability
+    using Codon = unsigned int;
+    using Codons = std::vector<Codon>;
+    using const_iterator = Codons::const_iterator;
+    using size_type = Codons::size_type;
+
+    Genotype();                                // Default constructor
+    Genotype(std::initializer_list<Codon>);    // Initialiser list constructor
+    Genotype(const Genotype &);                // Copy constructor - Shares the codons
+    Genotype(Genotype &&) noexcept;            // Move constructor
+    ~Genotype();                               // Destructor
+
+    // Assignment operators
+    Genotype &operator=(const Genotype &);     // Shares the codons
+    Genotype &operator=(Genotype &&) noexcept;
+
+    // Read-only access never copies the codons
+    const Codons &codons() const;
+    const_iterator begin() const;
+    const_iterator end() const;
+    size_type size() const;
+    bool empty() const;
+    Codon operator[](const size_type) const;
+    Codon at(const size_type) const;
+
+    // Write access - Copies the codons first if they are shared
+    Codons &modify();
+    void set(const size_type, const Codon);
+    void push_back(const Codon);
+    void reserve(const size_type);
+    void resize(const size_type);
+    void clear();
+
+    // Returns true if another genotype shares these codons
+    bool isShared() const;
+
+    // Get a hash of the first count codons, or all of them if there are fewer
+    std::size_t hash(const size_type count) const;
+
+private:
+    // Work methods
+    void keepBuffer();
+
+    // Shared codon buffer, null when the genotype is empty and unallocated
+    std::shared_ptr<Codons> buffer;
+
+    // Unshared buffer kept for the next copy on write, never shared with another genotype
+    std::shared_ptr<Codons> spare;
+
+    // Empty buffer returned for unallocated genotypes
+    static const Codons &emptyCodons();
+};
+
+// Default constructor
+inline Genotype::Genotype()
+{
+}
+
+// Initialiser list constructor
+inline Genotype::Genotype(std::initializer_list<Codon> codons) : buffer(std::make_shared<Codons>(codons))
+{
+}
+
+// Copy constructor
+inline Genotype::Genotype(const Genotype &copy) : buffer(copy.buffer)
+{
+}
+
+// Move constructor
+inline Genotype::Genotype(Genotype &&other) noexcept : buffer(std::move(other.buffer)),
+                                                       spare(std::move(other.spare))
+{
+}
+
+// Destructor
+inline Genotype::~Genotype()
+{
+}
+
+// Copy assignment
+inline Genotype &Genotype::operator=(const Genotype &copy)
+{
+    if (this->buffer != copy.buffer)
+    {
+        keepBuffer();
+        this->buffer = copy.buffer;
+    }
+    return *this;
+}
+
+// Move assignment
+inline Genotype &Genotype::operator=(Genotype &&other) noexcept
+{
+    if (this != &other)
+    {
+        keepBuffer();
+        this->buffer = std::move(other.buffer);
+        if (!this->spare)
+        {
+            this->spare = std::move(other.spare);
+        }
+    }
+    return *this;
+}
+
+// Read-only methods
+inline const Genotype::Codons &Genotype::codons() const
+{
+    return buffer ? *buffer : emptyCodons();
+}
+
+inline Genotype::const_iterator Genotype::begin() const
+{
+    return codons().begin();
+}
+
+inline Genotype::const_iterator Genotype::end() const
+{
+    return codons().end();
+}
+
+inline Genotype::size_type Genotype::size() const
+{
+    return buffer ? buffer->size() : 0;
+}
+
+inline bool Genotype::empty() const
+{
+    return size() == 0;
+}
+
+inline Genotype::Codon Genotype::operator[](const size_type index) const
+{
+    return (*buffer)[index];
+}
+
+inline Genotype::Codon Genotype::at(const size_type index) const
+{
+    return codons().at(index);
+}
+
+// Get a writable buffer, copying the codons if another genotype shares them
+inline Genotype::Codons &Genotype::modify()
+{
+    if (!buffer)
+    {
+        buffer = spare ? std::move(spare) : std::make_shared<Codons>();
+    }
+    else if (buffer.use_count() > 1 && spare)
+    {
+        spare->assign(buffer->begin(), buffer->end());
+        buffer = std::move(spare);
+    }
+    else if (buffer.use_count() > 1)
+    {
+        buffer = std::make_shared<Codons>(*buffer);
+    }
+
+    return *buffer;
+}
+
+inline void Genotype::set(const size_type index, const Codon codon)
+{
+    modify()[index] = codon;
+}
+
+inline void Genotype::push_back(const Codon codon)
+{
+    modify().push_back(codon);
+}
+
+inline void Genotype::reserve(const size_type capacity)
+{
+    modify().reserve(capacity);
+}
+
+inline void Genotype::resize(const size_type newSize)
+{
+    modify().resize(newSize);
+}
+
+// Clear the codons, keeping the buffer's capacity when it isn't shared
+inline void Genotype::clear()
+{
+    if (buffer && buffer.use_count() == 1)
+    {
+        buffer->clear();
+    }
+    else
+    {
+        buffer.reset();
+    }
+}
+
+inline bool Genotype::isShared() const
+{
+    return buffer && buffer.use_count() > 1;
+}
+
+// FNV-1a over whole codons
+inline std::size_t Genotype::hash(const size_type count) const
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    const Codons &codons = this->codons();
+    for (size_type index = 0, end = std::min(count, codons.size()); index < end; ++index)
+    {
+        hash ^= codons[index];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Keep the buffer as the spare before it is replaced, if nothing else uses it
+inline void Genotype::keepBuffer()
+{
+    if (buffer && buffer.use_count() == 1 && !spare)
+    {
+        buffer->clear();
+        spare = std::move(buffer);
+    }
+}
+
+inline const Genotype::Codons &Genotype::emptyCodons()
+{
+    static const Codons empty;
+    return empty;
+}
+
+#endif
@@ -0,0 +1,136 @@
+#ifndef _INCREMENTALERROR_HPP_
+#define _INCREMENTALERROR_HPP_
+
+// Include system libraries
+#include <cstddef>
+#include <limits>
+
+// This class adds up the errors of a dataset's rows, and can stop once the sum is past a limit.
+// Rows are summed in lanes, with row i going to lane i % lanes, then the lanes are added up and the
+// rows left over added one at a time. The lanes can be summed with vector instructions, and code that
+// sums in the same order gets exactly the same result.
+// The sum is checked against the limit every checkRows rows. Errors are never negative, so the sum so far
+// is a bound below the full sum, and once it is past the limit the rest of the rows can't bring it back.
+class IncrementalError
+{
+public:
+    static constexpr std::size_t lanes = 16;      // Partial sums kept when adding up errors
+    static constexpr std::size_t checkRows = 256; // Rows between checks against the limit, a multiple of lanes
+
+    IncrementalError();  // Default constructor
+    ~IncrementalError(); // Destructor
+
+    // Start a new sum over rowCount rows, stopping once it is above the limit
+    void reset(const std::size_t rowCount, const double limit = std::numeric_limits<double>::infinity());
+
+    // Add error(values[i] - target[i]) for the next count rows, returning false once the sum is past the limit
+    // Rows must be added in order, count at a time, where count is a multiple of checkRows except for the last rows
+    template <class ERROR>
+    bool add(const float *values, const float *target, const std::size_t count, ERROR error);
+
+    // Whether the sum was stopped at the limit
+    bool isStopped() const;
+
+    // Get the sum, or the bound it was stopped at
+    double getSum() const;
+
+    // Get the rows added so far
+    std::size_t getRows() const;
+
+private:
+    // Private variables
+    float laneSums[lanes];
+    double sum;
+    double limit;
+    std::size_t rowCount;
+    std::size_t laneRows; // Rows that go to the lanes, a multiple of lanes
+    std::size_t rows;     // Rows added so far
+    bool stopped;
+};
+
+// Default constructor
+inline IncrementalError::IncrementalError()
+{
+    reset(0);
+}
+
+// Destructor
+inline IncrementalError::~IncrementalError()
+{
+}
+
+inline void IncrementalError::reset(const std::size_t rowCount, const double limit)
+{
+    for (float &laneSum : laneSums)
+    {
+        laneSum = 0.0f;
+    }
+    sum = 0.0;
+    this->limit = limit;
+    this->rowCount = rowCount;
+    laneRows = rowCount - rowCount % lanes;
+    rows = 0;
+    stopped = false;
+}
+
+template <class ERROR>
+bool IncrementalError::add(const float *values, const float *target, const std::size_t count, ERROR error)
+{
+    std::size_t i = 0;
+    for (; i + lanes <= count && rows + i < laneRows; i += lanes)
+    {
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            laneSums[lane] += error(values[i + lane] - target[i + lane]);
+        }
+    }
+
+    // Add up the lanes once they are full, then the rows left over
+    if (i < count || rows + count == laneRows)
+    {
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            sum += laneSums[lane];
+            laneSums[lane] = 0.0f;
+        }
+        for (; i < count; ++i)
+        {
+            sum += error(values[i] - target[i]);
+        }
+    }
+    rows += count;
+
+    // Check the bound between checks, but not once every row has been added
+    if (rows % checkRows == 0 && rows < rowCount)
+    {
+        double bound = sum;
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+        {
+            bound += laneSums[lane];
+        }
+
+        if (bound > limit)
+        {
+            sum = bound;
+            stopped = true;
+        }
+    }
+    return !stopped;
+}
+
+inline bool IncrementalError::isStopped() const
+{
+    return stopped;
+}
+
+inline double IncrementalError::getSum() const
+{
+    return sum;
+}
+
+inline std::size_t IncrementalError::getRows() const
+{
+    return rows;
+}
+
+#endif
@@ -0,0 +1,189 @@
+#ifndef _INDEXEDHEAP_HPP_
+#define _INDEXEDHEAP_HPP_
+
+// Include system libraries
+#include <vector>
+#include <functional>
+#include <cstddef>
+
+// This template class implements a binary heap over the items 0 to size - 1.
+// Each item has a key, and the heap keeps track of where each item is, so the key of
+// any item can be changed in O(log N). The top item is one that no other item comes before.
+// With the default comparison, the top item has the smallest key.
+template <class KEY, class COMPARE = std::less<KEY>>
+class IndexedHeap
+{
+public:
+    IndexedHeap(const COMPARE &compare = COMPARE()); // Default constructor
+    ~IndexedHeap();                                  // Destructor
+
+    // Replace the heap with the given keys, item i having keys[i], in O(N)
+    void assign(const std::vector<KEY> &keys);
+
+    // Change the key of an item, in O(log N)
+    void update(const std::size_t item, const KEY &key);
+
+    // Get methods
+    std::size_t top() const;
+    const KEY &getKey(const std::size_t item) const;
+    std::size_t size() const;
+    bool empty() const;
+
+    void clear();
+
+private:
+    // Work methods
+    void siftUp(std::size_t position);
+    void siftDown(std::size_t position);
+    void place(const std::size_t position, const std::size_t item);
+
+    // Private variables
+    COMPARE compare;
+    std::vector<KEY> keys;               // Key of each item
+    std::vector<std::size_t> heap;       // Items in heap order
+    std::vector<std::size_t> positions;  // Position of each item in the heap
+};
+
+// Default constructor
+template <class KEY, class COMPARE>
+IndexedHeap<KEY, COMPARE>::IndexedHeap(const COMPARE &compare) : compare(compare)
+{
+}
+
+// Destructor
+template <class KEY, class COMPARE>
+IndexedHeap<KEY, COMPARE>::~IndexedHeap()
+{
+}
+
+// Build the heap bottom up
+template <class KEY, class COMPARE>
+void IndexedHeap<KEY, COMPARE>::assign(const std::vector<KEY> &keys)
+{
+    this->keys = keys;
+    heap.resize(keys.size());
+    positions.resize(keys.size());
+
+    for (std::size_t item = 0; item < keys.size(); ++item)
+    {
+        heap[item] = item;
+        positions[item] = item;
+    }
+
+    for (std::size_t position = heap.size() / 2; position-- > 0;)
+    {
+        siftDown(position);
+    }
+}
+
+// Move the item up or down to its new place
+template <class KEY, class COMPARE>
+void IndexedHeap<KEY, COMPARE>::update(const std::size_t item, const KEY &key)
+{
+    bool isEarlier = compare(key, keys[item]);
+    keys[item] = key;
+
+    if (isEarlier)
+    {
+        siftUp(positions[item]);
+    }
+    else
+    {
+        siftDown(positions[item]);
+    }
+}
+
+// Get methods
+template <class KEY, class COMPARE>
+std::size_t IndexedHeap<KEY, COMPARE>::top() const
+{
+    return heap.front();
+}
+
+template <class KEY, class COMPARE>
+const KEY &IndexedHeap<KEY, COMPARE>::getKey(const std::size_t item) const
+{
+    return keys[item];
+}
+
+template <class KEY, class COMPARE>
+std::size_t IndexedHeap<KEY, COMPARE>::size() const
+{
+    return heap.size();
+}
+
+template <class KEY, class COMPARE>
+bool IndexedHeap<KEY, COMPARE>::empty() const
+{
+    return heap.empty();
+}
+
+template <class KEY, class COMPARE>
+void IndexedHeap<KEY, COMPARE>::clear()
+{
+    keys.clear();
+    heap.clear();
+    positions.clear();
+}
+
+// Move the item at the position towards the top until its parent comes before it
+template <class KEY, class COMPARE>
+void IndexedHeap<KEY, COMPARE>::siftUp(std::size_t position)
+{
+    std::size_t item = heap[position];
+
+    while (position > 0)
+    {
+        std::size_t parent = (position - 1) / 2;
+        if (!compare(keys[item], keys[heap[parent]]))
+        {
+            break;
+        }
+
+        place(position, heap[parent]);
+        position = parent;
+    }
+
+    place(position, item);
+}
+
+// Move the item at the position towards the bottom until it comes before both children
+template <class KEY, class COMPARE>
+void IndexedHeap<KEY, COMPARE>::siftDown(std::size_t position)
+{
+    std::size_t item = heap[position];
+
+    while (true)
+    {
+        std::size_t child = 2 * position + 1;
+        if (child >= heap.size())
+        {
+            break;
+        }
+
+        // Take the child that comes first
+        if (child + 1 < heap.size() && compare(keys[heap[child + 1]], keys[heap[child]]))
+        {
+            ++child;
+        }
+
+        if (!compare(keys[heap[child]], keys[item]))
+        {
+            break;
+        }
+
+        place(position, heap[child]);
+        position = child;
+    }
+
+    place(position, item);
+}
+
+template <class KEY, class COMPARE>
+void IndexedHeap<KEY, COMPARE>::place(const std::size_t position, const std::size_t item)
+{
+    heap[position] = item;
+    positions[item] = position;
+}
+
+#endif
@@ -0,0 +1,208 @@
+#ifndef _LRUCACHE_HPP_
+#define _LRUCACHE_HPP_
+
+// Include system libraries
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+
+// This template class implements a least recently used cache with a fixed number of entries.
+// Entries are kept in one buffer and linked by index in order of use, so once the cache is
+// full, inserting an entry reuses the slot of the least recently used one without allocating.
+// Nothing is reserved up front, so a large capacity only costs memory once the entries fill it.
+template <class KEY, class VALUE>
+class LRUCache
+{
+public:
+    LRUCache(const std::size_t capacity = 0); // Default constructor
+    ~LRUCache();                              // Destructor
+
+    // Find the value of a key, marking it as the most recently used
+    // Returns nullptr if the key isn't in the cache
+    const VALUE *find(const KEY &key);
+
+    // Add or replace the value of a key, evicting the least recently used entry if the cache is full
+    void insert(const KEY &key, const VALUE &value);
+
+    // Remove every entry and change the number of entries the cache can hold
+    void setCapacity(const std::size_t capacity);
+    void clear();
+
+    // Get methods
+    std::size_t size() const;
+    std::size_t getCapacity() const;
+
+    // Approximate memory used by each entry, including the index
+    static constexpr std::size_t entryBytes = sizeof(KEY) + sizeof(VALUE) + 2 * sizeof(std::uint32_t) + sizeof(KEY) + sizeof(std::uint32_t) + 3 * sizeof(void *);
+
+private:
+    static constexpr std::uint32_t none = UINT32_MAX;
+
+    struct Entry
+    {
+        KEY key;
+        VALUE value;
+        std::uint32_t previous; // Entry used more recently
+        std::uint32_t next;     // Entry used less recently
+    };
+
+    // Work methods
+    void unlink(const std::uint32_t entry);
+    void pushFront(const std::uint32_t entry);
+
+    // Private variables
+    std::vector<Entry> entries;
+    std::unordered_map<KEY, std::uint32_t> index; // Entry of each key
+    std::size_t capacity;
+    std::uint32_t head; // Most recently used
+    std::uint32_t tail; // Least recently used
+};
+
+// Default constructor
+template <class KEY, class VALUE>
+LRUCache<KEY, VALUE>::LRUCache(const std::size_t capacity)
+    : capacity(0),
+      head(none),
+      tail(none)
+{
+    setCapacity(capacity);
+}
+
+// Destructor
+template <class KEY, class VALUE>
+LRUCache<KEY, VALUE>::~LRUCache()
+{
+}
+
+template <class KEY, class VALUE>
+const VALUE *LRUCache<KEY, VALUE>::find(const KEY &key)
+{
+    typename std::unordered_map<KEY, std::uint32_t>::const_iterator found = index.find(key);
+    if (found == index.end())
+    {
+        return nullptr;
+    }
+
+    // Move the entry to the front
+    if (found->second != head)
+    {
+        unlink(found->second);
+        pushFront(found->second);
+    }
+    return &entries[found->second].value;
+}
+
+template <class KEY, class VALUE>
+void LRUCache<KEY, VALUE>::insert(const KEY &key, const VALUE &value)
+{
+    if (capacity == 0)
+    {
+        return;
+    }
+
+    // Replace the value of an existing key
+    typename std::unordered_map<KEY, std::uint32_t>::iterator found = index.find(key);
+    if (found != index.end())
+    {
+        entries[found->second].value = value;
+        if (found->second != head)
+        {
+            unlink(found->second);
+            pushFront(found->second);
+        }
+        return;
+    }
+
+    // Use a new slot until the cache is full, then the least recently used one
+    std::uint32_t entry;
+    if (entries.size() < capacity)
+    {
+        entry = entries.size();
+        entries.push_back(Entry{key, value, none, none});
+    }
+    else
+    {
+        entry = tail;
+        unlink(entry);
+        index.erase(entries[entry].key);
+        entries[entry].key = key;
+        entries[entry].value = value;
+    }
+
+    index.emplace(key, entry);
+    pushFront(entry);
+}
+
+template <class KEY, class VALUE>
+void LRUCache<KEY, VALUE>::setCapacity(const std::size_t capacity)
+{
+    clear();
+    this->capacity = capacity < none ? capacity : none - 1;
+}
+
+template <class KEY, class VALUE>
+void LRUCache<KEY, VALUE>::clear()
+{
+    entries.clear();
+    index.clear();
+    head = none;
+    tail = none;
+}
+
+// Get methods
+template <class KEY, class VALUE>
+std::size_t LRUCache<KEY, VALUE>::size() const
+{
+    return entries.size();
+}
+
+template <class KEY, class VALUE>
+std::size_t LRUCache<KEY, VALUE>::getCapacity() const
+{
+    return capacity;
+}
+
+// Take the entry out of the use order
+template <class KEY, class VALUE>
+void LRUCache<KEY, VALUE>::unlink(const std::uint32_t entry)
+{
+    Entry &current = entries[entry];
+    if (current.previous != none)
+    {
+        entries[current.previous].next = current.next;
+    }
+    else
+    {
+        head = current.next;
+    }
+
+    if (current.next != none)
+    {
+        entries[current.next].previous = current.previous;
+    }
+    else
+    {
+        tail = current.previous;
+    }
+}
+
+// Make the entry the most recently used
+template <class KEY, class VALUE>
+void LRUCache<KEY, VALUE>::pushFront(const std::uint32_t entry)
+{
+    entries[entry].previous = none;
+    entries[entry].next = head;
+    if (head != none)
+    {
+        entries[head].previous = entry;
+    }
+    head = entry;
+
+    if (tail == none)
+    {
+        tail = entry;
+    }
+}
+
+#endif
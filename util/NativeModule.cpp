@@ -0,0 +1,132 @@
+#ifndef _NATIVEMODULE_CPP_
+#define _NATIVEMODULE_CPP_
+
+#include "NativeModule.hpp"
+
+// Include system libraries
+#include <vector>
+#include <sstream>
+#include <cstdlib>
+#include <cerrno>
+#include <dlfcn.h>
+#include <fcntl.h>
+#include <spawn.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+// Run a command without a shell, with its output thrown away, returning true if it succeeds
+static bool runCommand(const std::vector<std::string> &command)
+{
+    std::vector<char *> arguments;
+    for (const std::string &argument : command)
+    {
+        arguments.push_back(const_cast<char *>(argument.c_str()));
+    }
+    arguments.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_adddup2(&actions, STDOUT_FILENO, STDERR_FILENO);
+
+    pid_t pid;
+    int error = posix_spawnp(&pid, arguments[0], &actions, nullptr, arguments.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    if (error != 0)
+    {
+        return false;
+    }
+
+    int status;
+    while (waitpid(pid, &status, 0) < 0)
+    {
+        if (errno != EINTR)
+        {
+            return false;
+        }
+    }
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Default constructor
+NativeModule::NativeModule() : handle(nullptr)
+{
+}
+
+// Destructor
+NativeModule::~NativeModule()
+{
+    close();
+}
+
+bool NativeModule::build(const std::string &source, const std::string &compiler, const std::string &flags, const std::string &directory)
+{
+    close();
+
+    // Make a unique file for the source
+    std::string pattern = directory + "/grace_native_XXXXXX";
+    std::vector<char> path(pattern.begin(), pattern.end());
+    path.push_back('\0');
+
+    int file = mkstemp(path.data());
+    if (file < 0)
+    {
+        return false;
+    }
+
+    std::string sourcePath(path.data());
+    std::string libraryPath = sourcePath + ".so";
+
+    bool isWritten = true;
+    for (std::size_t written = 0; isWritten && written < source.size();)
+    {
+        ssize_t count = write(file, source.data() + written, source.size() - written);
+        isWritten = count > 0;
+        written += isWritten ? count : 0;
+    }
+    ::close(file);
+
+    // The source file has no extension, so its language is given
+    if (isWritten)
+    {
+        std::vector<std::string> command = {compiler};
+        std::istringstream stream(flags);
+        std::string flag;
+        while (stream >> flag)
+        {
+            command.push_back(flag);
+        }
+        command.insert(command.end(), {"-shared", "-fPIC", "-o", libraryPath, "-x", "c", sourcePath, "-lm"});
+
+        if (runCommand(command))
+        {
+            handle = dlopen(libraryPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+        }
+    }
+
+    // The loaded object stays valid once its file is removed
+    unlink(sourcePath.c_str());
+    unlink(libraryPath.c_str());
+    return handle != nullptr;
+}
+
+void NativeModule::close()
+{
+    if (handle)
+    {
+        dlclose(handle);
+    }
+    handle = nullptr;
+}
+
+bool NativeModule::isOpen() const
+{
+    return handle != nullptr;
+}
+
+void *NativeModule::getSymbol(const std::string &name) const
+{
+    return handle ? dlsym(handle, name.c_str()) : nullptr;
+}
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef _NATIVEMODULE_HPP_
+#define _NATIVEMODULE_HPP_
+
+// Include system libraries
+#include <string>
+
+// This class compiles C source with the system compiler and loads the result as a shared object.
+// The source and shared object are written to temporary files, which are removed once the
+// object is loaded, and the object is unloaded when the module is destroyed.
+class NativeModule
+{
+public:
+    NativeModule();  // Default constructor
+    NativeModule(const NativeModule &) = delete; // The loaded object can't be copied
+    NativeModule &operator=(const NativeModule &) = delete;
+    ~NativeModule(); // Destructor
+
+    // Compile and load the source, returning false if it can't be compiled or loaded
+    // The compiler is run directly rather than through the shell, and flags are split into arguments at spaces
+    bool build(const std::string &source, const std::string &compiler, const std::string &flags, const std::string &directory);
+    void close();
+    bool isOpen() const;
+
+    // Find a function or variable in the loaded object, returning nullptr if there isn't one
+    void *getSymbol(const std::string &name) const;
+
+private:
+    // Private variables
+    void *handle;
+};
+
+#endif
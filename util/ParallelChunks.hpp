@@ -0,0 +1,109 @@
+#ifndef _PARALLELCHUNKS_HPP_
+#define _PARALLELCHUNKS_HPP_
+
+// Include system libraries
+#include <INIReader.h>
+#include <string>
+#include <memory>
+#include <thread>
+#include <iostream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstddef>
+
+// Include member classes
+#include "ThreadPool.hpp"
+
+// This class runs an operator's work over its individuals on a pool of worker threads.
+// The operator's settings give the number of threads and the population size from which the work is
+// split into chunks that run on the threads; smaller populations are done in one go on the calling thread.
+// Every individual must have its own random stream, so the result is the same whether the chunks run on
+// one thread or many.
+class ParallelChunks
+{
+public:
+    ParallelChunks(const std::size_t chunkSize, const std::size_t parallelThreshold); // Constructor
+    ~ParallelChunks();                                                                // Destructor
+
+    // Read the Threads and ParallelThreshold settings of the operator's section, and start the worker threads
+    // Threads = 0 uses every hardware thread
+    void parseSettings(INIReader &settings, const std::string &section);
+
+    // Call function(begin, end, chunk) over [0, count)
+    template <class FUNCTION>
+    void run(const std::size_t count, FUNCTION function);
+
+    // Get methods
+    unsigned int getThreads() const;
+
+private:
+    // Private variables
+    std::size_t chunkSize;         // Individuals handed to a thread at a time
+    std::size_t parallelThreshold; // Population size from which the work runs in chunks
+    unsigned int threads;
+    std::unique_ptr<ThreadPool> threadPool;
+};
+
+// Constructor
+inline ParallelChunks::ParallelChunks(const std::size_t chunkSize, const std::size_t parallelThreshold)
+    : chunkSize(chunkSize),
+      parallelThreshold(parallelThreshold),
+      threads(1)
+{
+}
+
+// Destructor
+inline ParallelChunks::~ParallelChunks()
+{
+}
+
+inline void ParallelChunks::parseSettings(INIReader &settings, const std::string &section)
+{
+    // Get number of threads, 0 uses every hardware thread
+    if (settings.HasValue(section, "Threads"))
+    {
+        long threads = settings.GetInteger(section, "Threads", 1);
+        if (threads < 0)
+        {
+            std::cout << "Error: Invalid " << section << " thread count. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->threads = threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+    }
+
+    // Get population size from which the work runs in parallel chunks
+    if (settings.HasValue(section, "ParallelThreshold"))
+    {
+        long parallelThreshold = settings.GetInteger(section, "ParallelThreshold", this->parallelThreshold);
+        if (parallelThreshold < 1)
+        {
+            std::cout << "Error: " << section << " parallel threshold must be at least 1. Exiting..." << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        this->parallelThreshold = parallelThreshold;
+    }
+
+    // Start the worker threads
+    threadPool.reset(threads > 1 ? new ThreadPool(threads) : nullptr);
+}
+
+template <class FUNCTION>
+void ParallelChunks::run(const std::size_t count, FUNCTION function)
+{
+    if (threadPool && count >= parallelThreshold)
+    {
+        threadPool->parallelFor(count, chunkSize, function);
+    }
+    else
+    {
+        function(0, count, 0);
+    }
+}
+
+// Get methods
+inline unsigned int ParallelChunks::getThreads() const
+{
+    return threads;
+}
+
+#endif
@@ -0,0 +1,310 @@
+#ifndef _PERSISTENTCACHE_CPP_
+#define _PERSISTENTCACHE_CPP_
+
+#include "PersistentCache.hpp"
+
+// Include system libraries
+#include <cstring>
+#include <cerrno>
+#include <thread>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// Processes share the slots' atomics through the mapping, which needs them to be lock free
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "PersistentCache needs lock free atomics");
+
+// Default constructor
+PersistentCache::PersistentCache() : mapping(nullptr),
+                                     mappingSize(0),
+                                     slots(nullptr),
+                                     mask(0)
+{
+}
+
+// Destructor
+PersistentCache::~PersistentCache()
+{
+    close();
+}
+
+// The first process to open the file creates the table, holding a lock so no other process sees it half made
+bool PersistentCache::open(const std::string &path, const std::size_t capacity)
+{
+    close();
+
+    int file = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+    if (file < 0)
+    {
+        return false;
+    }
+
+    if (flock(file, LOCK_EX) != 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    bool isValid = false;
+    struct stat status;
+    if (fstat(file, &status) == 0)
+    {
+        if (status.st_size == 0)
+        {
+            // Round the capacity up to a power of two, so probing can wrap with a mask
+            std::size_t slotCount = 64;
+            while (slotCount < capacity)
+            {
+                slotCount *= 2;
+            }
+
+            // The new file is filled with zeros, which leaves every slot empty
+            std::size_t size = sizeof(Header) + slotCount * sizeof(Slot);
+            if (ftruncate(file, size) == 0)
+            {
+                mapping = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+                if (mapping != MAP_FAILED)
+                {
+                    mappingSize = size;
+                    Header *header = static_cast<Header *>(mapping);
+                    header->magic = fileMagic;
+                    header->version = fileVersion;
+                    header->capacity = slotCount;
+                    isValid = true;
+                }
+            }
+        }
+        else if (static_cast<std::size_t>(status.st_size) >= sizeof(Header))
+        {
+            // Check that the existing file is a cache of the right size
+            mapping = mmap(nullptr, status.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, file, 0);
+            if (mapping != MAP_FAILED)
+            {
+                mappingSize = status.st_size;
+                const Header *header = static_cast<const Header *>(mapping);
+                std::size_t slotCount = header->capacity;
+                isValid = header->magic == fileMagic && header->version == fileVersion &&
+                          slotCount > 0 && (slotCount & (slotCount - 1)) == 0 &&
+                          mappingSize == sizeof(Header) + slotCount * sizeof(Slot);
+            }
+        }
+    }
+
+    // The mapping stays valid once the file is closed
+    flock(file, LOCK_UN);
+    ::close(file);
+
+    if (mapping == MAP_FAILED)
+    {
+        mapping = nullptr;
+        mappingSize = 0;
+    }
+
+    if (!isValid)
+    {
+        close();
+        return false;
+    }
+
+    slots = reinterpret_cast<Slot *>(static_cast<char *>(mapping) + sizeof(Header));
+    mask = static_cast<const Header *>(mapping)->capacity - 1;
+    return true;
+}
+
+void PersistentCache::close()
+{
+    if (mapping)
+    {
+        munmap(mapping, mappingSize);
+    }
+
+    mapping = nullptr;
+    mappingSize = 0;
+    slots = nullptr;
+    mask = 0;
+}
+
+bool PersistentCache::isOpen() const
+{
+    return mapping != nullptr;
+}
+
+// Probe from the phenotype's start slot until it is found or an empty slot is reached
+bool PersistentCache::find(const std::uint64_t problemId, const std::uint64_t hash, float &score) const
+{
+    if (!mapping)
+    {
+        return false;
+    }
+
+    std::size_t start = getStart(problemId, hash);
+    for (std::size_t probe = 0; probe < maxProbes; ++probe)
+    {
+        Slot &slot = slots[(start + probe) & mask];
+        std::uint32_t state = slot.state.load(std::memory_order_acquire);
+
+        if (state == Empty)
+        {
+            return false;
+        }
+
+        // Skip slots whose writer doesn't finish, and slots emptied because their writer died
+        if (isWriting(state) && (!waitForSlot(slot, state) || state == Empty))
+        {
+            continue;
+        }
+
+        if (isMatch(slot, problemId, hash))
+        {
+            std::uint32_t bits = slot.score.load(std::memory_order_acquire);
+            std::memcpy(&score, &bits, sizeof(score));
+            return true;
+        }
+    }
+    return false;
+}
+
+// Claim the first empty slot, or update the slot already holding the phenotype
+bool PersistentCache::insert(const std::uint64_t problemId, const std::uint64_t hash, const float score)
+{
+    if (!mapping)
+    {
+        return false;
+    }
+
+    std::uint32_t bits;
+    std::memcpy(&bits, &score, sizeof(bits));
+
+    std::uint32_t writingState = getWritingState();
+    std::size_t start = getStart(problemId, hash);
+    for (std::size_t probe = 0; probe < maxProbes; ++probe)
+    {
+        Slot &slot = slots[(start + probe) & mask];
+        std::uint32_t state = slot.state.load(std::memory_order_acquire);
+
+        while (state != Ready)
+        {
+            // Fill an empty slot, then publish it
+            if (state == Empty && slot.state.compare_exchange_strong(state, writingState, std::memory_order_acquire))
+            {
+                slot.problemId = problemId;
+                slot.hash = hash;
+                slot.score.store(bits, std::memory_order_relaxed);
+                slot.state.store(Ready, std::memory_order_release);
+                return true;
+            }
+
+            // Another process got there first, so wait to see what it wrote
+            // The slot is empty again if that process died, and can be claimed
+            if (isWriting(state) && !waitForSlot(slot, state))
+            {
+                break;
+            }
+        }
+
+        if (state == Ready && isMatch(slot, problemId, hash))
+        {
+            slot.score.store(bits, std::memory_order_release);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Scan the whole table
+void PersistentCache::forEach(const std::uint64_t problemId, const std::function<void(std::uint64_t, float)> &function) const
+{
+    if (!mapping)
+    {
+        return;
+    }
+
+    for (std::size_t index = 0; index <= mask; ++index)
+    {
+        const Slot &slot = slots[index];
+        if (slot.state.load(std::memory_order_acquire) == Ready && slot.problemId == problemId)
+        {
+            float score;
+            std::uint32_t bits = slot.score.load(std::memory_order_acquire);
+            std::memcpy(&score, &bits, sizeof(score));
+            function(slot.hash, score);
+        }
+    }
+}
+
+std::size_t PersistentCache::getCapacity() const
+{
+    return mapping ? mask + 1 : 0;
+}
+
+// FNV-1a hash of the name
+std::uint64_t PersistentCache::getProblemId(const std::string &name)
+{
+    std::uint64_t hash = 14695981039346656037ULL;
+    for (const char character : name)
+    {
+        hash ^= static_cast<unsigned char>(character);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+// Mix both keys, as phenotype hashes of different problems may be close together
+std::size_t PersistentCache::getStart(const std::uint64_t problemId, const std::uint64_t hash) const
+{
+    std::uint64_t z = hash ^ (problemId * 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return (z ^ (z >> 31)) & mask;
+}
+
+// Wait a short while for a slot's writer to publish it, returning false if it is still writing
+// A process that dies while writing leaves its slot unfinished, so once the wait is over a slot whose
+// writer no longer exists is emptied again. If the writer's process id was reused, the slot is only skipped
+bool PersistentCache::waitForSlot(Slot &slot, std::uint32_t &state) const
+{
+    for (unsigned int attempt = 0; attempt < 1024; ++attempt)
+    {
+        state = slot.state.load(std::memory_order_acquire);
+        if (!isWriting(state))
+        {
+            return true;
+        }
+        std::this_thread::yield();
+    }
+
+    pid_t writer = state >> stateBits;
+    if (kill(writer, 0) == 0 || errno != ESRCH)
+    {
+        return false;
+    }
+
+    // Only one waiter empties the slot; the others see what it became
+    if (slot.state.compare_exchange_strong(state, Empty, std::memory_order_acq_rel))
+    {
+        state = Empty;
+        return true;
+    }
+    return !isWriting(state);
+}
+
+bool PersistentCache::isMatch(const Slot &slot, const std::uint64_t problemId, const std::uint64_t hash)
+{
+    return slot.problemId == problemId && slot.hash == hash;
+}
+
+bool PersistentCache::isWriting(const std::uint32_t state)
+{
+    return (state & ((1u << stateBits) - 1)) == Writing;
+}
+
+// Process ids fit in the bits above the state, as Linux allows at most 2^22 of them
+std::uint32_t PersistentCache::getWritingState()
+{
+    return static_cast<std::uint32_t>(getpid()) << stateBits | Writing;
+}
+
+#endif
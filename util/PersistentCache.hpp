@@ -0,0 +1,93 @@
+#ifndef _PERSISTENTCACHE_HPP_
+#define _PERSISTENTCACHE_HPP_
+
+// Include system libraries
+#include <string>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+// This class implements a score cache kept in a file, so that runs can share scores.
+// The file is a memory-mapped open addressing hash table keyed by a problem id and a phenotype hash.
+// Slots are claimed and published with atomic operations on the mapped memory, so any number of
+// local processes can read and write the same file at once without locks. The table never grows;
+// once a phenotype's probe sequence is full, new scores for it are not stored.
+// A slot being written holds its writer's process id, so a slot left unfinished by a process that died
+// is emptied again by the next process that waits on it.
+class PersistentCache
+{
+public:
+    PersistentCache();  // Default constructor
+    PersistentCache(const PersistentCache &) = delete; // The mapping can't be copied
+    PersistentCache &operator=(const PersistentCache &) = delete;
+    ~PersistentCache(); // Destructor
+
+    // Open the file, creating it with room for capacity scores if it doesn't exist
+    // An existing file keeps the capacity it was created with. Returns false if the file can't be used
+    bool open(const std::string &path, const std::size_t capacity);
+    void close();
+    bool isOpen() const;
+
+    // Find the score of a phenotype, returning false if it isn't stored
+    bool find(const std::uint64_t problemId, const std::uint64_t hash, float &score) const;
+
+    // Store the score of a phenotype, replacing any stored score. Returns false if there was no room
+    bool insert(const std::uint64_t problemId, const std::uint64_t hash, const float score);
+
+    // Call function(hash, score) for every score stored for the problem
+    void forEach(const std::uint64_t problemId, const std::function<void(std::uint64_t, float)> &function) const;
+
+    // Get methods
+    std::size_t getCapacity() const;
+
+    // Get an id for a problem from its name
+    static std::uint64_t getProblemId(const std::string &name);
+
+private:
+    // A slot is empty, being written by a process, or ready to be read
+    // The state of a slot being written also holds the writer's process id above the state bits
+    enum SlotState : std::uint32_t
+    {
+        Empty = 0,
+        Writing = 1,
+        Ready = 2
+    };
+    static constexpr unsigned int stateBits = 2;
+
+    struct Slot
+    {
+        std::atomic<std::uint32_t> state;
+        std::atomic<std::uint32_t> score; // Bits of the float score
+        std::uint64_t problemId;
+        std::uint64_t hash;
+        std::uint64_t reserved;
+    };
+
+    struct Header
+    {
+        std::uint64_t magic;
+        std::uint64_t version;
+        std::uint64_t capacity; // Number of slots, a power of two
+        std::uint64_t reserved;
+    };
+
+    // Work methods
+    std::size_t getStart(const std::uint64_t problemId, const std::uint64_t hash) const;
+    bool waitForSlot(Slot &slot, std::uint32_t &state) const;
+    static bool isMatch(const Slot &slot, const std::uint64_t problemId, const std::uint64_t hash);
+    static bool isWriting(const std::uint32_t state);
+    static std::uint32_t getWritingState();
+
+    // Private variables
+    static constexpr std::uint64_t fileMagic = 0x4548434543415247ULL; // "GRACECHE" - Marks a score cache file
+    static constexpr std::uint64_t fileVersion = 2;
+    static constexpr std::size_t maxProbes = 64; // Slots checked before giving up
+
+    void *mapping;
+    std::size_t mappingSize;
+    Slot *slots;
+    std::size_t mask;
+};
+
+#endif
@@ -0,0 +1,129 @@
+#ifndef _RANDOMENGINES_HPP_
+#define _RANDOMENGINES_HPP_
+
+// Include system libraries
+#include <cstdint>
+#include <limits>
+
+// These classes implement random number engines that can be used in place of the standard library's.
+// They meet the UniformRandomBitGenerator requirements, so they work with the standard distributions.
+
+// SplitMix64 (Steele, Lea & Flood)
+// Mostly used to turn a single seed into the state of the other engines
+class SplitMix64
+{
+public:
+    using result_type = std::uint64_t;
+
+    SplitMix64(const std::uint64_t seed = 0) : state(seed){}; // Default constructor
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    void seed(const std::uint64_t seed) { state = seed; }
+
+    result_type operator()()
+    {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+private:
+    std::uint64_t state;
+};
+
+// xoshiro256++ (Blackman & Vigna)
+// Fast 64 bit engine with 256 bits of state
+class Xoshiro256PlusPlus
+{
+public:
+    using result_type = std::uint64_t;
+
+    Xoshiro256PlusPlus(const std::uint64_t seed = 0) { this->seed(seed); } // Default constructor
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    // The state is filled from SplitMix64, so it is never all zero
+    void seed(const std::uint64_t seed)
+    {
+        SplitMix64 seeder(seed);
+        for (std::uint64_t &word : state)
+        {
+            word = seeder();
+        }
+    }
+
+    result_type operator()()
+    {
+        const std::uint64_t result = rotl(state[0] + state[3], 23) + state[0];
+        const std::uint64_t t = state[1] << 17;
+
+        state[2] ^= state[0];
+        state[3] ^= state[1];
+        state[1] ^= state[2];
+        state[0] ^= state[3];
+        state[2] ^= t;
+        state[3] = rotl(state[3], 45);
+
+        return result;
+    }
+
+    // Comparison operators, as for the standard engines
+    bool operator==(const Xoshiro256PlusPlus &other) const
+    {
+        return state[0] == other.state[0] && state[1] == other.state[1] && state[2] == other.state[2] && state[3] == other.state[3];
+    }
+    bool operator!=(const Xoshiro256PlusPlus &other) const { return !(*this == other); }
+
+private:
+    static std::uint64_t rotl(const std::uint64_t x, const int k) { return (x << k) | (x >> (64 - k)); }
+
+    std::uint64_t state[4];
+};
+
+// PCG32 - PCG-XSH-RR with 64 bits of state (O'Neill)
+// Small 32 bit engine; each stream gives an independent sequence for the same seed
+class PCG32
+{
+public:
+    using result_type = std::uint32_t;
+
+    PCG32(const std::uint64_t seed = 0, const std::uint64_t stream = defaultStream) { this->seed(seed, stream); } // Default constructor
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+
+    void seed(const std::uint64_t seed, const std::uint64_t stream = defaultStream)
+    {
+        state = 0;
+        increment = (stream << 1) | 1;
+        (*this)();
+        state += seed;
+        (*this)();
+    }
+
+    result_type operator()()
+    {
+        const std::uint64_t old = state;
+        state = old * 6364136223846793005ULL + increment;
+
+        const std::uint32_t shifted = ((old >> 18) ^ old) >> 27;
+        const std::uint32_t rotation = old >> 59;
+        return (shifted >> rotation) | (shifted << ((-rotation) & 31));
+    }
+
+    // Comparison operators, as for the standard engines
+    bool operator==(const PCG32 &other) const { return state == other.state && increment == other.increment; }
+    bool operator!=(const PCG32 &other) const { return !(*this == other); }
+
+private:
+    static constexpr std::uint64_t defaultStream = 721347520444481703ULL;
+
+    std::uint64_t state;
+    std::uint64_t increment;
+};
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef _THREADPOOL_HPP_
+#define _THREADPOOL_HPP_
+
+// Include system libraries
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+
+// This class implements a fixed pool of worker threads used by the operators.
+// Work is split into fixed-size chunks that are handed out dynamically, so the
+// chunk boundaries (and anything seeded per chunk) never depend on the number of threads.
+class ThreadPool
+{
+public:
+    ThreadPool(const unsigned int threads = std::thread::hardware_concurrency()); // Default constructor
+    ThreadPool(const ThreadPool &) = delete; // Workers can't be copied
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool(); // Destructor
+
+    // Get the number of threads, including the calling thread
+    unsigned int size() const;
+
+    // Call function(begin, end, chunk) for each chunk of [0, count) and wait for all chunks.
+    // The calling thread also runs chunks
+    template <class FUNCTION>
+    void parallelFor(const std::size_t count, const std::size_t chunkSize, FUNCTION function);
+
+private:
+    // Work methods
+    void workerLoop();
+    void runChunks();
+
+    // Private variables
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable doneCondition;
+    std::function<void(std::size_t)> job;  // Runs a single chunk of the current job
+    std::size_t jobChunks;
+    std::atomic<std::size_t> nextChunk;
+    std::atomic<std::size_t> pendingChunks;
+    unsigned long long jobId;              // Incremented for every job so workers know there is new work
+    unsigned int busyWorkers;
+    bool stopping;
+};
+
+// Default constructor
+inline ThreadPool::ThreadPool(const unsigned int threads)
+    : jobChunks(0),
+      nextChunk(0),
+      pendingChunks(0),
+      jobId(0),
+      busyWorkers(0),
+      stopping(false)
+{
+    // The calling thread is one of the threads
+    for (unsigned int i = 1; i < threads; ++i)
+    {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+// Destructor
+inline ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+
+    for (std::thread &worker : workers)
+    {
+        worker.join();
+    }
+}
+
+inline unsigned int ThreadPool::size() const
+{
+    return workers.size() + 1;
+}
+
+template <class FUNCTION>
+void ThreadPool::parallelFor(const std::size_t count, const std::size_t chunkSize, FUNCTION function)
+{
+    std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+
+    // Run the chunks on this thread if there's nothing to share
+    if (workers.empty() || chunks <= 1)
+    {
+        for (std::size_t chunk = 0; chunk < chunks; ++chunk)
+        {
+            function(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize), chunk);
+        }
+        return;
+    }
+
+    // Publish the job once the workers have left the previous one
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        doneCondition.wait(lock, [this]
+                           { return busyWorkers == 0; });
+
+        job = [&function, count, chunkSize](std::size_t chunk)
+        { function(chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize), chunk); };
+        jobChunks = chunks;
+        nextChunk = 0;
+        pendingChunks = chunks;
+        ++jobId;
+    }
+    wakeCondition.notify_all();
+
+    // Help with the job
+    runChunks();
+
+    // Wait for the other threads to finish their chunks
+    std::unique_lock<std::mutex> lock(mutex);
+    doneCondition.wait(lock, [this]
+                       { return pendingChunks == 0 && busyWorkers == 0; });
+}
+
+// Wait for jobs and run their chunks
+inline void ThreadPool::workerLoop()
+{
+    unsigned long long lastJobId = 0;
+
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [this, lastJobId]
+                               { return stopping || jobId != lastJobId; });
+
+            if (stopping)
+            {
+                return;
+            }
+
+            lastJobId = jobId;
+            ++busyWorkers;
+        }
+
+        runChunks();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            --busyWorkers;
+        }
+        doneCondition.notify_all();
+    }
+}
+
+// Take chunks from the current job until there are none left
+inline void ThreadPool::runChunks()
+{
+    std::size_t chunk;
+    while ((chunk = nextChunk.fetch_add(1)) < jobChunks)
+    {
+        job(chunk);
+
+        if (pendingChunks.fetch_sub(1) == 1)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            doneCondition.notify_all();
+        }
+    }
+}
+
+#endif
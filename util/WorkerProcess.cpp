@@ -0,0 +1,175 @@
+#ifndef _WORKERPROCESS_CPP_
+#define _WORKERPROCESS_CPP_
+
+#include "WorkerProcess.hpp"
+
+// Include system libraries
+#include <cerrno>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+
+// Default constructor
+WorkerProcess::WorkerProcess() : pid(-1),
+                                 descriptor(-1),
+                                 outputSent(0)
+{
+}
+
+// Destructor
+WorkerProcess::~WorkerProcess()
+{
+    stop();
+}
+
+bool WorkerProcess::start(const std::vector<std::string> &command)
+{
+    stop();
+
+    if (command.empty())
+    {
+        return false;
+    }
+
+    int sockets[2];
+    if (socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, sockets) != 0)
+    {
+        return false;
+    }
+
+    // Build the arguments before forking, so the child only makes async-signal-safe calls
+    std::vector<char *> arguments;
+    for (const std::string &argument : command)
+    {
+        arguments.push_back(const_cast<char *>(argument.c_str()));
+    }
+    arguments.push_back(nullptr);
+
+    pid = fork();
+    if (pid < 0)
+    {
+        close(sockets[0]);
+        close(sockets[1]);
+        return false;
+    }
+
+    if (pid == 0)
+    {
+        // The duplicates lose close-on-exec, so only they survive into the command
+        dup2(sockets[1], STDIN_FILENO);
+        dup2(sockets[1], STDOUT_FILENO);
+        execvp(arguments[0], arguments.data());
+        _exit(127);
+    }
+
+    close(sockets[1]);
+    descriptor = sockets[0];
+    fcntl(descriptor, F_SETFL, fcntl(descriptor, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+void WorkerProcess::stop()
+{
+    if (descriptor >= 0)
+    {
+        close(descriptor);
+    }
+
+    if (pid > 0)
+    {
+        kill(pid, SIGKILL);
+        waitpid(pid, nullptr, 0);
+    }
+
+    pid = -1;
+    descriptor = -1;
+    output.clear();
+    outputSent = 0;
+    input.clear();
+}
+
+bool WorkerProcess::isRunning() const
+{
+    return pid > 0;
+}
+
+// Once the process is collected its id may be reused, so it is forgotten and never killed
+bool WorkerProcess::hasExited()
+{
+    if (pid > 0 && waitpid(pid, nullptr, WNOHANG) == pid)
+    {
+        pid = -1;
+    }
+    return pid <= 0;
+}
+
+int WorkerProcess::getDescriptor() const
+{
+    return descriptor;
+}
+
+void WorkerProcess::send(const std::string &line)
+{
+    output += line;
+    output += '\n';
+}
+
+bool WorkerProcess::hasPendingOutput() const
+{
+    return outputSent < output.size();
+}
+
+bool WorkerProcess::flush()
+{
+    while (outputSent < output.size())
+    {
+        ssize_t count = ::send(descriptor, output.data() + outputSent, output.size() - outputSent, MSG_NOSIGNAL);
+        if (count < 0)
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+        outputSent += count;
+    }
+
+    output.clear();
+    outputSent = 0;
+    return true;
+}
+
+bool WorkerProcess::receive()
+{
+    char buffer[4096];
+    while (true)
+    {
+        ssize_t count = read(descriptor, buffer, sizeof(buffer));
+        if (count > 0)
+        {
+            input.append(buffer, count);
+        }
+        else if (count == 0)
+        {
+            return false;
+        }
+        else
+        {
+            return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR;
+        }
+    }
+}
+
+bool WorkerProcess::nextLine(std::string &line)
+{
+    std::size_t end = input.find('\n');
+    if (end == std::string::npos)
+    {
+        return false;
+    }
+
+    line.assign(input, 0, end);
+    input.erase(0, end + 1);
+    return true;
+}
+
+#endif
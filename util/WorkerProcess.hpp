@@ -0,0 +1,56 @@
+#ifndef _WORKERPROCESS_HPP_
+#define _WORKERPROCESS_HPP_
+
+// Include system libraries
+#include <string>
+#include <vector>
+#include <sys/types.h>
+
+// This class runs a command as a child process and talks to it a line at a time.
+// The child's standard input and output are one end of a socket pair, and the other end is
+// non-blocking, so lines can be sent and replies read as the socket allows without ever stalling.
+// Sending never raises SIGPIPE, so a child that dies shows up as a failed flush or receive.
+class WorkerProcess
+{
+public:
+    WorkerProcess();  // Default constructor
+    WorkerProcess(const WorkerProcess &) = delete; // The process can't be copied
+    WorkerProcess &operator=(const WorkerProcess &) = delete;
+    ~WorkerProcess(); // Destructor
+
+    // Start the command, searching the path for it. Stops any process already running
+    bool start(const std::vector<std::string> &command);
+
+    // Kill the process and wait for it to end
+    void stop();
+    bool isRunning() const;
+
+    // Returns true if the process has ended by itself, collecting its exit status without waiting
+    bool hasExited();
+
+    // Get the socket to poll, readable when there are replies and writable when more can be sent
+    int getDescriptor() const;
+
+    // Queue a line to be sent
+    void send(const std::string &line);
+    bool hasPendingOutput() const;
+
+    // Send as much of the queue as the socket takes, returning false if the process has gone
+    bool flush();
+
+    // Read whatever the process has written, returning false if it has closed its end
+    bool receive();
+
+    // Take the next full line read, without its newline
+    bool nextLine(std::string &line);
+
+private:
+    // Private variables
+    pid_t pid;
+    int descriptor;
+    std::string output;      // Queued for sending
+    std::size_t outputSent;  // Bytes at the start of the queue already sent
+    std::string input;       // Read but not yet taken
+};
+
+#endif
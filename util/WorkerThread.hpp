@@ -0,0 +1,100 @@
+#ifndef _WORKERTHREAD_HPP_
+#define _WORKERTHREAD_HPP_
+
+// Include system libraries
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <type_traits>
+
+// This class implements a single long-lived thread that runs tasks in the order they are given.
+// Each task's result is handed back through a future, so work can overlap with the caller
+// without starting a thread for every task. Tasks still queued when it is destroyed are run first.
+class WorkerThread
+{
+public:
+    WorkerThread();  // Default constructor
+    WorkerThread(const WorkerThread &) = delete; // The thread can't be copied
+    WorkerThread &operator=(const WorkerThread &) = delete;
+    ~WorkerThread(); // Destructor
+
+    // Queue function() to run on the thread, returning a future for its result
+    template <class FUNCTION>
+    std::future<std::invoke_result_t<FUNCTION>> run(FUNCTION function);
+
+private:
+    // Work methods
+    void workerLoop();
+
+    // Private variables
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::deque<std::function<void()>> tasks;
+    bool stopping;
+    std::thread worker; // Started last, once everything it uses is ready
+};
+
+// Default constructor
+inline WorkerThread::WorkerThread()
+    : stopping(false),
+      worker(&WorkerThread::workerLoop, this)
+{
+}
+
+// Destructor
+inline WorkerThread::~WorkerThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_one();
+    worker.join();
+}
+
+template <class FUNCTION>
+std::future<std::invoke_result_t<FUNCTION>> WorkerThread::run(FUNCTION function)
+{
+    // The task is shared, as std::function needs something it can copy
+    using Result = std::invoke_result_t<FUNCTION>;
+    std::shared_ptr<std::packaged_task<Result()>> task = std::make_shared<std::packaged_task<Result()>>(std::move(function));
+    std::future<Result> result = task->get_future();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.emplace_back([task]
+                           { (*task)(); });
+    }
+    wakeCondition.notify_one();
+    return result;
+}
+
+// Wait for tasks and run them, until stopped with nothing left to do
+inline void WorkerThread::workerLoop()
+{
+    while (true)
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wakeCondition.wait(lock, [this]
+                               { return stopping || !tasks.empty(); });
+
+            if (tasks.empty())
+            {
+                return;
+            }
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+
+        task();
+    }
+}
+
+#endif